@@ -14,6 +14,8 @@
 #include <limits>
 #include <stdexcept>
 #include "my_integer.hpp"
+#include "graph_reader.hpp"
+#include "shortest_path_tree.hpp"
 
 template <typename T>
 class Graph {
@@ -67,23 +69,22 @@ class Graph {
 template <typename T>
 Graph<T>::Graph(int N) : adjList(N), numVertices {N} {}
 
+// the file can be in EWD or DIMACS format, see graph_reader.hpp
 template <typename T>
 Graph<T>::Graph(const std::string& inputFile) {
-  std::ifstream infile {inputFile};
-  if (!infile) {
-    std::cerr << inputFile << " could not be opened\n";
-    return;
-  }
-  // first line has number of vertices
-  infile >> numVertices;
+  EdgeList edges {readEdgeList(inputFile)};
+  numVertices = edges.numVertices;
   adjList.resize(numVertices);
-  int i {};
-  int j {};
-  double weight {};
-  // assume each remaining line is of form
-  // origin dest weight
-  while (infile >> i >> j >> weight) {
-    addEdge(i, j, static_cast<T>(weight));
+  // size each hash map once up front instead of rehashing as it grows
+  std::vector<int> outDegree(numVertices);
+  for (int from : edges.from) {
+    ++outDegree.at(from);
+  }
+  for (int i = 0; i < numVertices; ++i) {
+    adjList[i].reserve(outDegree[i]);
+  }
+  for (int e = 0; e < edges.numEdges(); ++e) {
+    addEdge(edges.from[e], edges.to[e], static_cast<T>(edges.weights[e]));
   }
 }
 
@@ -133,9 +134,15 @@ std::ostream& operator<<(std::ostream& out, const Graph<T>& G) {
   return out;
 }
 
+// The checkers are templated on the graph type as well as the weight type.
+// They work with any graph offering the read-only interface of Graph<T>
+// (size, neighbours, isEdge, getEdgeWeight), for example the CompactGraph<T>
+// in compact_graph.hpp.
+
 // The isSubgraph function checks if H is a subraph of G(the original graph)
-template <typename T>
-bool isSubgraph(const Graph<T>& H, const Graph<T>& G) {
+template <typename T, template <typename> class TreeType,
+          template <typename> class GraphType>
+bool isSubgraph(const TreeType<T>& H, const GraphType<T>& G) {
 
   if (H.size() > G.size()) {
     return false;
@@ -157,8 +164,8 @@ bool isSubgraph(const Graph<T>& H, const Graph<T>& G) {
   return true;
 }
 
-template <typename T>
-bool isTreePlusIsolated(const Graph<T>& G, int root) {
+template <typename T, template <typename> class GraphType>
+bool isTreePlusIsolated(const GraphType<T>& G, int root) {
   //BFS. If visited already, cycle exists! return false.
   std::queue<int> graphQueue {}; //storing int number of vertices
   std::vector<bool> visited(G.size());
@@ -199,8 +206,8 @@ T infinity() {
   }
 }
 
-template <typename T>
-std::vector<T> pathLengthsFromRoot(const Graph<T>& tree, int root) { 
+template <typename T, template <typename> class GraphType>
+std::vector<T> pathLengthsFromRoot(const GraphType<T>& tree, int root) { 
   std::vector<T> bestDistanceTo(tree.size(), infinity<T>());//makes the bestDistanceTo //size and each elements starting point
   std::queue<int> treeQueue {};
   std::vector<bool> visited(tree.size()); 
@@ -231,8 +238,108 @@ std::vector<T> pathLengthsFromRoot(const Graph<T>& tree, int root) {
 
 
 
+// The checkers below take a ShortestPathTree<T> (shortest_path_tree.hpp)
+// directly, so a search result can be checked without turning it into a
+// Graph<T> first.  Each vertex has at most one parent, so following parents
+// visits every vertex at most once when finished chains are remembered.
+
+// every tree edge parent(v) -> v must be an edge of G with the same weight
+template <typename T, template <typename> class GraphType>
+bool isSubgraph(const ShortestPathTree<T>& tree, const GraphType<T>& G) {
+  if (tree.size() > G.size()) {
+    return false;
+  }
+  for (int v {}; v < tree.size(); v++) {
+    int parent = tree.parent(v);
+    if (parent == -1) {
+      continue;
+    }
+    if (!G.isEdge(parent, v)) {
+      return false;
+    }
+    if (G.getEdgeWeight(parent, v) != tree.parentWeight(v)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// following parents from any vertex with a parent must lead to root
+// without going round a cycle.  Vertices without a parent are isolated.
 template <typename T>
-bool allEdgesRelaxed(const std::vector<T>& bestDistanceTo, const Graph<T>& G, 
+bool isTreePlusIsolated(const ShortestPathTree<T>& tree, int root) {
+  int N = tree.size();
+  if (root != tree.source() or tree.parent(root) != -1) {
+    return false;
+  }
+  // leadsToRoot.at(v) is true once the parent chain of v is known to end at root
+  std::vector<bool> leadsToRoot(N);
+  leadsToRoot.at(root) = true;
+  std::vector<int> chain {};
+  for (int v {}; v < N; v++) {
+    if (tree.parent(v) == -1) {
+      continue;
+    }
+    chain.clear();
+    int current = v;
+    while (current != -1 and !leadsToRoot.at(current)) {
+      // a chain longer than N vertices must go round a cycle
+      if (static_cast<int>(chain.size()) == N) {
+        return false;
+      }
+      chain.push_back(current);
+      current = tree.parent(current);
+      if (current < -1 or current >= N) {
+        return false;
+      }
+    }
+    if (current == -1) {
+      // ended at a vertex other than root
+      return false;
+    }
+    for (int w : chain) {
+      leadsToRoot.at(w) = true;
+    }
+  }
+  return true;
+}
+
+// add up the parent edge weights from each vertex back to root.  Vertices
+// whose parents do not lead to root get infinity<T>()
+template <typename T>
+std::vector<T> pathLengthsFromRoot(const ShortestPathTree<T>& tree, int root) {
+  int N = tree.size();
+  std::vector<T> bestDistanceTo(N, infinity<T>());
+  // 0 not looked at yet, 1 length known, 2 does not lead to root
+  std::vector<char> state(N);
+  bestDistanceTo.at(root) = T {};
+  state.at(root) = 1;
+  std::vector<int> chain {};
+  for (int v {}; v < N; v++) {
+    chain.clear();
+    int current = v;
+    while (current != -1 and state.at(current) == 0
+           and static_cast<int>(chain.size()) < N) {
+      chain.push_back(current);
+      current = tree.parent(current);
+    }
+    bool known = current != -1 and state.at(current) == 1;
+    // walk back down the chain adding one edge at a time
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      if (known) {
+        bestDistanceTo.at(*it) = bestDistanceTo.at(tree.parent(*it))
+                                 + tree.parentWeight(*it);
+        state.at(*it) = 1;
+      } else {
+        state.at(*it) = 2;
+      }
+    }
+  }
+  return bestDistanceTo;
+}
+
+template <typename T, template <typename> class GraphType>
+bool allEdgesRelaxed(const std::vector<T>& bestDistanceTo, const GraphType<T>& G, 
                       int source) {
   
   if (bestDistanceTo.at(source) != T{}){
@@ -0,0 +1,332 @@
+#ifndef GRAPH_READER_HPP_
+#define GRAPH_READER_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads weighted directed graphs from text files in either of the two
+// formats we use:
+//
+// EWD (as in tinyEWD.txt): the first line is the number of vertices,
+// every following line is "origin dest weight" with 0-based vertices.
+// A lone second line holding the number of edges is skipped.
+//
+// DIMACS (as in USA-road-d.NY.gr): "c" lines are comments, a single
+// "p sp N M" line gives the number of vertices and edges, and every
+// "a u v w" line is an arc with 1-based vertices.
+//
+// The whole file is read into memory, split into one chunk per thread
+// on line boundaries, and each chunk is parsed in parallel with the hand
+// written number parsers below rather than with iostreams.
+
+enum class GraphFileFormat { EWD, DIMACS };
+
+// edges in the order they appear in the file, with 0-based vertex ids
+struct EdgeList {
+  int numVertices {};
+  std::vector<int> from {};
+  std::vector<int> to {};
+  std::vector<double> weights {};
+
+  int numEdges() const {
+    return static_cast<int>(from.size());
+  }
+};
+
+namespace graph_reader_detail {
+
+inline bool isSpace(char c) {
+  return c == ' ' or c == '\t' or c == '\r';
+}
+
+inline bool isDigit(char c) {
+  return c >= '0' and c <= '9';
+}
+
+inline void skipSpaces(const char*& p, const char* end) {
+  while (p < end and isSpace(*p)) {
+    ++p;
+  }
+}
+
+inline void skipLine(const char*& p, const char* end) {
+  while (p < end and *p != '\n') {
+    ++p;
+  }
+  if (p < end) {
+    ++p;
+  }
+}
+
+// parse an optionally signed integer starting at p
+// returns false, leaving p alone, if there is no number there
+inline bool parseInt(const char*& p, const char* end, long long& value) {
+  skipSpaces(p, end);
+  const char* q = p;
+  bool negative = false;
+  if (q < end and (*q == '-' or *q == '+')) {
+    negative = *q == '-';
+    ++q;
+  }
+  if (q == end or not isDigit(*q)) {
+    return false;
+  }
+  long long result = 0;
+  while (q < end and isDigit(*q)) {
+    result = 10 * result + (*q - '0');
+    ++q;
+  }
+  value = negative ? -result : result;
+  p = q;
+  return true;
+}
+
+// parse a decimal number such as 11712, -0.35 or 1.5e3 starting at p
+// returns false, leaving p alone, if there is no number there
+inline bool parseNumber(const char*& p, const char* end, double& value) {
+  static const double powersOfTen[] {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  skipSpaces(p, end);
+  const char* start = p;
+  const char* q = p;
+  bool negative = false;
+  if (q < end and (*q == '-' or *q == '+')) {
+    negative = *q == '-';
+    ++q;
+  }
+  unsigned long long mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool sawDigit = false;
+  while (q < end and isDigit(*q)) {
+    sawDigit = true;
+    if (digits < 19) {
+      mantissa = 10 * mantissa + (*q - '0');
+      if (mantissa != 0) {
+        ++digits;
+      }
+    } else {
+      ++exponent;
+    }
+    ++q;
+  }
+  if (q < end and *q == '.') {
+    ++q;
+    while (q < end and isDigit(*q)) {
+      sawDigit = true;
+      if (digits < 19) {
+        mantissa = 10 * mantissa + (*q - '0');
+        if (mantissa != 0) {
+          ++digits;
+        }
+        --exponent;
+      }
+      ++q;
+    }
+  }
+  if (not sawDigit) {
+    return false;
+  }
+  if (q + 1 < end and (*q == 'e' or *q == 'E') and not isSpace(q[1])) {
+    const char* e = q + 1;
+    long long power {};
+    if (parseInt(e, end, power)) {
+      exponent += static_cast<int>(power);
+      q = e;
+    }
+  }
+  // mantissa and 10^|exponent| are both exact doubles here, so one
+  // multiplication or division gives the correctly rounded result.
+  // Anything else is rare enough to hand to strtod.
+  if (digits <= 15 and exponent >= -22 and exponent <= 22) {
+    double result = static_cast<double>(mantissa);
+    result = exponent < 0 ? result / powersOfTen[-exponent]
+                          : result * powersOfTen[exponent];
+    value = negative ? -result : result;
+  } else {
+    value = std::strtod(std::string(start, q).c_str(), nullptr);
+  }
+  p = q;
+  return true;
+}
+
+// edges found in one chunk of the file
+struct Chunk {
+  std::vector<int> from {};
+  std::vector<int> to {};
+  std::vector<double> weights {};
+  long long numVertices = -1;
+};
+
+inline void parseEWDChunk(const char* p, const char* end, Chunk& chunk) {
+  while (p < end) {
+    long long i {};
+    long long j {};
+    double weight {};
+    const char* line = p;
+    if (parseInt(p, end, i) and parseInt(p, end, j)
+        and parseNumber(p, end, weight)) {
+      chunk.from.push_back(static_cast<int>(i));
+      chunk.to.push_back(static_cast<int>(j));
+      chunk.weights.push_back(weight);
+    }
+    p = line;
+    skipLine(p, end);
+  }
+}
+
+inline void parseDIMACSChunk(const char* p, const char* end, Chunk& chunk) {
+  while (p < end) {
+    skipSpaces(p, end);
+    if (p < end and *p == 'a') {
+      ++p;
+      long long u {};
+      long long v {};
+      double weight {};
+      if (parseInt(p, end, u) and parseInt(p, end, v)
+          and parseNumber(p, end, weight)) {
+        // DIMACS vertices are numbered from 1
+        chunk.from.push_back(static_cast<int>(u - 1));
+        chunk.to.push_back(static_cast<int>(v - 1));
+        chunk.weights.push_back(weight);
+      }
+    } else if (p < end and *p == 'p') {
+      ++p;
+      skipSpaces(p, end);
+      while (p < end and not isSpace(*p) and *p != '\n') {
+        ++p;
+      }
+      long long n {};
+      if (parseInt(p, end, n)) {
+        chunk.numVertices = n;
+      }
+    }
+    skipLine(p, end);
+  }
+}
+
+}  // namespace graph_reader_detail
+
+// DIMACS files start with a "c" or "p" line, EWD files with a number
+inline GraphFileFormat detectFormat(const char* p, const char* end) {
+  while (p < end and (graph_reader_detail::isSpace(*p) or *p == '\n')) {
+    ++p;
+  }
+  if (p < end and (*p == 'c' or *p == 'p' or *p == 'a')) {
+    return GraphFileFormat::DIMACS;
+  }
+  return GraphFileFormat::EWD;
+}
+
+// parse a whole file already in memory using numThreads threads
+inline EdgeList parseEdgeList(const char* begin, const char* end,
+                              int numThreads) {
+  using namespace graph_reader_detail;
+  EdgeList edges {};
+  const char* body = begin;
+  GraphFileFormat format = detectFormat(begin, end);
+  if (format == GraphFileFormat::EWD) {
+    // first line has number of vertices
+    long long n {};
+    if (not parseInt(body, end, n)) {
+      return edges;
+    }
+    edges.numVertices = static_cast<int>(n);
+    skipLine(body, end);
+  }
+
+  // split the rest of the file into chunks that end on a newline
+  numThreads = std::max(1, numThreads);
+  std::vector<const char*> bounds {body};
+  for (int t = 1; t < numThreads; ++t) {
+    const char* cut = body + (end - body) * t / numThreads;
+    cut = std::max(cut, bounds.back());
+    skipLine(cut, end);
+    bounds.push_back(cut);
+  }
+  bounds.push_back(end);
+
+  std::vector<Chunk> chunks(numThreads);
+  auto parseChunk = [&](int t) {
+    if (format == GraphFileFormat::EWD) {
+      parseEWDChunk(bounds.at(t), bounds.at(t + 1), chunks.at(t));
+    } else {
+      parseDIMACSChunk(bounds.at(t), bounds.at(t + 1), chunks.at(t));
+    }
+  };
+  std::vector<std::thread> threads {};
+  for (int t = 1; t < numThreads; ++t) {
+    threads.emplace_back(parseChunk, t);
+  }
+  parseChunk(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // glue the chunks back together in file order
+  std::size_t total = 0;
+  for (const auto& chunk : chunks) {
+    total += chunk.from.size();
+    if (chunk.numVertices >= 0) {
+      edges.numVertices = static_cast<int>(chunk.numVertices);
+    }
+  }
+  edges.from.reserve(total);
+  edges.to.reserve(total);
+  edges.weights.reserve(total);
+  for (auto& chunk : chunks) {
+    edges.from.insert(edges.from.end(), chunk.from.begin(), chunk.from.end());
+    edges.to.insert(edges.to.end(), chunk.to.begin(), chunk.to.end());
+    edges.weights.insert(edges.weights.end(), chunk.weights.begin(),
+                         chunk.weights.end());
+    chunk = Chunk {};
+  }
+  for (int e = 0; e < edges.numEdges(); ++e) {
+    if (edges.from[e] < 0 or edges.from[e] >= edges.numVertices
+        or edges.to[e] < 0 or edges.to[e] >= edges.numVertices) {
+      throw std::out_of_range("invalid vertex number");
+    }
+  }
+  return edges;
+}
+
+inline int defaultReaderThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// read an EWD or DIMACS file, detecting which one it is
+// if the file cannot be opened an empty edge list is returned
+inline EdgeList readEdgeList(const std::string& inputFile,
+                             int numThreads = defaultReaderThreads()) {
+  std::FILE* file = std::fopen(inputFile.c_str(), "rb");
+  if (file == nullptr) {
+    std::cerr << inputFile << " could not be opened\n";
+    return EdgeList {};
+  }
+  std::vector<char> buffer {};
+  std::fseek(file, 0, SEEK_END);
+  long length = std::ftell(file);
+  std::fseek(file, 0, SEEK_SET);
+  if (length > 0) {
+    buffer.resize(length);
+    buffer.resize(std::fread(buffer.data(), 1, length, file));
+  }
+  std::fclose(file);
+  // small files are not worth starting threads for
+  if (buffer.size() < (1u << 20)) {
+    numThreads = 1;
+  }
+  return parseEdgeList(buffer.data(), buffer.data() + buffer.size(),
+                       numThreads);
+}
+
+#endif      // GRAPH_READER_HPP_
@@ -6,6 +6,7 @@
 #include <unordered_set>
 #include <cassert>
 #include "graph.hpp"
+#include "compact_graph.hpp"
 
 
 TEST(IsSubgraph, sameGraph) {
@@ -265,6 +266,106 @@ TEST(EdgesRelaxedTest, dijkstraFail) {
   EXPECT_FALSE(allEdgesRelaxed(bestDistanceTo, G, 0));
 }
 
+TEST(CompactGraphCheck, subgraphOfCompact) {
+  Graph<int> G {4};
+  G.addEdge(0, 1, 4);
+  G.addEdge(0, 2, 5);
+  G.addEdge(2, 1, -3);
+  G.addEdge(1, 3, 1);
+  CompactGraph<int> C {G};
+  Graph<int> H {4};
+  H.addEdge(0, 2, 5);
+  H.addEdge(2, 1, -3);
+  H.addEdge(1, 3, 1);
+  EXPECT_TRUE(isSubgraph(H, C));
+  EXPECT_TRUE(isSubgraph(C, G));
+  H.addEdge(3, 0, 2);
+  EXPECT_FALSE(isSubgraph(H, C));
+}
+
+TEST(CompactGraphCheck, treeAndPathLengths) {
+  Graph<int> G {8};
+  G.addEdge(3, 2, 1);
+  G.addEdge(3, 4, 4);
+  G.addEdge(7, 5, -10);
+  G.addEdge(7, 6, 2);
+  G.addEdge(3, 7, 3);
+  G.addEdge(4, 1, -5);
+  G.addEdge(2, 0, 11);
+  CompactGraph<int> C {G};
+  EXPECT_TRUE(isTreePlusIsolated(C, 3));
+  std::vector<int> distances {12, -1, 1, 0, 4, -7, 5, 3};
+  EXPECT_EQ(pathLengthsFromRoot(C, 3), distances);
+}
+
+TEST(CompactGraphCheck, edgesRelaxed) {
+  Graph<int> G(5);
+  G.addEdge(0, 1, 4);
+  G.addEdge(1, 2, -2);
+  G.addEdge(2, 3, -2);
+  G.addEdge(3, 4, 1);
+  G.addEdge(0, 3, 2);
+  CompactGraph<int> C {G};
+  std::vector<int> bestDistanceTo {0, 4, 2, 0, 3};
+  EXPECT_FALSE(allEdgesRelaxed(bestDistanceTo, C, 0));
+  bestDistanceTo = {0, 4, 2, 0, 1};
+  EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, C, 0));
+}
+
+// the tree of pathLengths.rootNotZero as parent arrays
+ShortestPathTree<int> rootNotZeroTree() {
+  std::vector<int> parent {2, 4, 3, -1, 3, 7, 7, 3};
+  std::vector<int> parentWeight {11, -5, 1, 0, 4, -10, 2, 3};
+  std::vector<int> distance {12, -1, 1, 0, 4, -7, 5, 3};
+  return {3, parent, distance, parentWeight};
+}
+
+TEST(ShortestPathTreeCheck, subgraph) {
+  Graph<int> G {8};
+  G.addEdge(3, 2, 1);
+  G.addEdge(3, 4, 4);
+  G.addEdge(7, 5, -10);
+  G.addEdge(7, 6, 2);
+  G.addEdge(3, 7, 3);
+  G.addEdge(4, 1, -5);
+  G.addEdge(2, 0, 11);
+  G.addEdge(0, 1, 6);
+  EXPECT_TRUE(isSubgraph(rootNotZeroTree(), G));
+  EXPECT_TRUE(isSubgraph(rootNotZeroTree(), CompactGraph<int> {G}));
+  G.removeEdge(7, 6);
+  G.addEdge(7, 6, 3);
+  EXPECT_FALSE(isSubgraph(rootNotZeroTree(), G));
+  Graph<int> small {7};
+  EXPECT_FALSE(isSubgraph(rootNotZeroTree(), small));
+}
+
+TEST(ShortestPathTreeCheck, treeAndPathLengths) {
+  ShortestPathTree<int> tree = rootNotZeroTree();
+  EXPECT_TRUE(isTreePlusIsolated(tree, 3));
+  EXPECT_FALSE(isTreePlusIsolated(tree, 0));
+  std::vector<int> distances {12, -1, 1, 0, 4, -7, 5, 3};
+  EXPECT_EQ(pathLengthsFromRoot(tree, 3), distances);
+  EXPECT_EQ(pathLengthsFromRoot(tree, 3), pathLengthsFromRoot(tree.toGraph(), 3));
+}
+
+TEST(ShortestPathTreeCheck, isolatedVertex) {
+  // vertex 2 is not reached
+  ShortestPathTree<int> tree {0, {-1, 0, -1, 1}, {0, 5, infinity<int>(), 7},
+                              {0, 5, 0, 2}};
+  EXPECT_TRUE(isTreePlusIsolated(tree, 0));
+  std::vector<int> distances {0, 5, infinity<int>(), 7};
+  EXPECT_EQ(pathLengthsFromRoot(tree, 0), distances);
+}
+
+TEST(ShortestPathTreeCheck, cycle) {
+  // 1 -> 2 -> 3 -> 1 never leads back to the root
+  ShortestPathTree<int> tree {0, {-1, 3, 1, 2}, {0, 1, 2, 3}, {0, 1, 1, 1}};
+  EXPECT_FALSE(isTreePlusIsolated(tree, 0));
+  std::vector<int> distances {0, infinity<int>(), infinity<int>(),
+                              infinity<int>()};
+  EXPECT_EQ(pathLengthsFromRoot(tree, 0), distances);
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,334 @@
+#ifndef ALT_HPP_
+#define ALT_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "graph.hpp"
+#include "graph_binary.hpp"
+#include "thread_pool.hpp"
+
+// ALT: A* with landmarks and the triangle inequality (Goldberg and
+// Harrelson).  For a landmark L and any vertices v and t
+//   d(v, t) >= d(L, t) - d(L, v)   and   d(v, t) >= d(v, L) - d(t, L),
+// so with the distances from and to a few landmarks worked out once, the
+// largest of these differences is a lower bound on d(v, t) that needs no
+// coordinates.  It is consistent on every edge from which the target can
+// still be reached, which is all aStar needs of a heuristic:
+//
+//   LandmarkTables<int> tables {G, 16};
+//   auto [path, length] = aStar(G, s, t, tables);
+//
+// Landmarks work best far out at the edges of the graph, behind the
+// targets as seen from the sources, which is what farthest selection
+// aims for.
+
+// header of saved landmark tables, laid out like BinaryGraphHeader
+struct LandmarkTablesHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t weightSize;
+  std::uint32_t weightKind;
+  std::uint32_t reserved;      // written as zero
+  std::uint64_t numVertices;
+  std::uint64_t numLandmarks;
+  std::uint64_t checksum;
+  std::uint64_t unused[2];     // written as zero, pads the header to 64 bytes
+};
+
+static_assert(sizeof(LandmarkTablesHeader) == 64);
+
+inline constexpr char landmarkTablesMagic[8] {'I', 'P', 'Q', 'A', 'L', 'T', 'L', 'M'};
+inline constexpr std::uint32_t landmarkTablesVersion = 1;
+
+// where the tables for a graph file are kept by convention, next to it
+inline std::string landmarkTablesFile(const std::string& graphFile) {
+  return graphFile + ".landmarks";
+}
+
+template <typename T>
+class LandmarkTables {
+ private:
+  int N = 0;
+  std::vector<int> landmarks_ {};
+  // d(landmark i, v) at fromLandmark[v * k + i] and d(v, landmark i) at
+  // toLandmark[v * k + i], infinity<T>() if there is no path.  A vertex's
+  // entries are next to each other, so a bound reads two short runs
+  std::vector<T> fromLandmark {};
+  std::vector<T> toLandmark {};
+
+ public:
+  // tables for numLandmarks landmarks picked by farthest selection: the
+  // first is the vertex farthest from vertex 0, each next one the vertex
+  // farthest from all landmarks so far, vertices no landmark reaches
+  // counting as farthest.  Each pick needs the distances from the previous
+  // landmarks, so the searches from the landmarks run one after another;
+  // the searches to them then run on numThreads threads
+  template <template <typename> class GraphType>
+  LandmarkTables(const GraphType<T>& G, int numLandmarks,
+                 int numThreads = defaultThreadCount());
+
+  // tables for the given landmarks, with all searches on numThreads threads
+  template <template <typename> class GraphType>
+  LandmarkTables(const GraphType<T>& G, const std::vector<int>& landmarks,
+                 int numThreads = defaultThreadCount());
+
+  // load tables written by save(), throws std::runtime_error if the file
+  // does not hold tables or they were saved with a different weight type
+  explicit LandmarkTables(const std::string& filename);
+
+  void save(const std::string& filename) const;
+
+  // number of vertices of the graph the tables were built for
+  int size() const;
+
+  int numLandmarks() const;
+
+  const std::vector<int>& landmarks() const;
+
+  // d(landmark i, v) and d(v, landmark i)
+  const T& distanceFrom(int i, int v) const;
+  const T& distanceTo(int i, int v) const;
+
+  // lower bound on the distance from v to target, the heuristic for aStar.
+  // 0 if no landmark tells anything
+  T operator()(int v, int target) const;
+
+ private:
+  template <template <typename> class GraphType>
+  void build(const GraphType<T>& G, std::vector<std::vector<T> > from,
+             int numThreads);
+};
+
+template <typename T>
+template <template <typename> class GraphType>
+LandmarkTables<T>::LandmarkTables(const GraphType<T>& G, int numLandmarks,
+                                  int numThreads)
+    : N {G.size()} {
+  if (numLandmarks < 1 or numLandmarks > N) {
+    throw std::invalid_argument("number of landmarks must be between 1 and the number of vertices");
+  }
+  std::vector<std::vector<T> > from {};
+  // distance from the nearest landmark picked so far
+  std::vector<T> nearest(singleSourceIndexTree(G, 0).distances());
+  for (int i = 0; i < numLandmarks; ++i) {
+    int farthest = 0;
+    for (int v = 1; v < N; ++v) {
+      if (nearest.at(farthest) < nearest.at(v)) {
+        farthest = v;
+      }
+    }
+    landmarks_.push_back(farthest);
+    from.push_back(singleSourceIndexTree(G, farthest).distances());
+    for (int v = 0; v < N; ++v) {
+      // the first landmark starts the minimum over landmarks afresh
+      if (i == 0 or from.back().at(v) < nearest.at(v)) {
+        nearest.at(v) = from.back().at(v);
+      }
+    }
+  }
+  build(G, std::move(from), numThreads);
+}
+
+template <typename T>
+template <template <typename> class GraphType>
+LandmarkTables<T>::LandmarkTables(const GraphType<T>& G,
+                                  const std::vector<int>& landmarks,
+                                  int numThreads)
+    : N {G.size()}, landmarks_ {landmarks} {
+  if (landmarks_.empty()) {
+    throw std::invalid_argument("at least one landmark is needed");
+  }
+  for (int landmark : landmarks_) {
+    if (landmark < 0 or landmark >= N) {
+      throw std::out_of_range("invalid vertex number");
+    }
+  }
+  build(G, {}, numThreads);
+}
+
+// run the searches missing from from, and all searches to the landmarks,
+// then interleave them into the tables
+template <typename T>
+template <template <typename> class GraphType>
+void LandmarkTables<T>::build(const GraphType<T>& G,
+                              std::vector<std::vector<T> > from,
+                              int numThreads) {
+  numThreads = effectiveThreads<T>(numThreads);
+  int k = numLandmarks();
+  const auto& R = G.reverse();
+  int searchesDone = static_cast<int>(from.size());
+  from.resize(k);
+  std::vector<std::vector<T> > to(k);
+  // search j < k is from landmark j, search k + j to it
+  int searches = 2 * k - searchesDone;
+  ThreadPool pool {std::max(1, std::min(numThreads, searches))};
+  pool.run([&](int thread) {
+    for (int j = searchesDone + thread; j < 2 * k; j += pool.size()) {
+      if (j < k) {
+        from.at(j) = singleSourceIndexTree(G, landmarks_.at(j)).distances();
+      } else {
+        to.at(j - k) = singleSourceIndexTree(R, landmarks_.at(j - k)).distances();
+      }
+    }
+  });
+  fromLandmark.resize(static_cast<std::size_t>(N) * k);
+  toLandmark.resize(static_cast<std::size_t>(N) * k);
+  for (int v = 0; v < N; ++v) {
+    for (int i = 0; i < k; ++i) {
+      fromLandmark.at(static_cast<std::size_t>(v) * k + i) = from.at(i).at(v);
+      toLandmark.at(static_cast<std::size_t>(v) * k + i) = to.at(i).at(v);
+    }
+  }
+}
+
+template <typename T>
+int LandmarkTables<T>::size() const {
+  return N;
+}
+
+template <typename T>
+int LandmarkTables<T>::numLandmarks() const {
+  return static_cast<int>(landmarks_.size());
+}
+
+template <typename T>
+const std::vector<int>& LandmarkTables<T>::landmarks() const {
+  return landmarks_;
+}
+
+template <typename T>
+const T& LandmarkTables<T>::distanceFrom(int i, int v) const {
+  if (v < 0 or v >= N) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  return fromLandmark.at(static_cast<std::size_t>(v) * numLandmarks() + i);
+}
+
+template <typename T>
+const T& LandmarkTables<T>::distanceTo(int i, int v) const {
+  if (v < 0 or v >= N) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  return toLandmark.at(static_cast<std::size_t>(v) * numLandmarks() + i);
+}
+
+template <typename T>
+T LandmarkTables<T>::operator()(int v, int target) const {
+  int k = numLandmarks();
+  const T* fromV = fromLandmark.data() + static_cast<std::size_t>(v) * k;
+  const T* fromTarget = fromLandmark.data() + static_cast<std::size_t>(target) * k;
+  const T* toV = toLandmark.data() + static_cast<std::size_t>(v) * k;
+  const T* toTarget = toLandmark.data() + static_cast<std::size_t>(target) * k;
+  const T unreachable = infinity<T>();
+  T bound {};
+  for (int i = 0; i < k; ++i) {
+    // differences with an infinite side say nothing usable
+    if (fromV[i] < fromTarget[i] and fromTarget[i] != unreachable) {
+      T gap = distanceGap(fromTarget[i], fromV[i]);
+      if (bound < gap) {
+        bound = gap;
+      }
+    }
+    if (toTarget[i] < toV[i] and toV[i] != unreachable) {
+      T gap = distanceGap(toV[i], toTarget[i]);
+      if (bound < gap) {
+        bound = gap;
+      }
+    }
+  }
+  return bound;
+}
+
+template <typename T>
+void LandmarkTables<T>::save(const std::string& outputFile) const {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "saved landmark tables need a trivially copyable weight type");
+  LandmarkTablesHeader header {};
+  std::memcpy(header.magic, landmarkTablesMagic, sizeof(header.magic));
+  header.version = landmarkTablesVersion;
+  header.weightSize = sizeof(T);
+  header.weightKind = binaryWeightKind<T>();
+  header.numVertices = N;
+  header.numLandmarks = landmarks_.size();
+  std::uint64_t hash = fnv1a(landmarks_.data(), sizeof(int) * landmarks_.size());
+  hash = fnv1a(fromLandmark.data(), sizeof(T) * fromLandmark.size(), hash);
+  hash = fnv1a(toLandmark.data(), sizeof(T) * toLandmark.size(), hash);
+  header.checksum = hash;
+
+  std::ofstream outfile {outputFile, std::ios::binary | std::ios::trunc};
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be opened for writing");
+  }
+  outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  outfile.write(reinterpret_cast<const char*>(landmarks_.data()),
+                sizeof(int) * landmarks_.size());
+  outfile.write(reinterpret_cast<const char*>(fromLandmark.data()),
+                sizeof(T) * fromLandmark.size());
+  outfile.write(reinterpret_cast<const char*>(toLandmark.data()),
+                sizeof(T) * toLandmark.size());
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be written");
+  }
+}
+
+template <typename T>
+LandmarkTables<T>::LandmarkTables(const std::string& inputFile) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "saved landmark tables need a trivially copyable weight type");
+  std::ifstream infile {inputFile, std::ios::binary};
+  if (!infile) {
+    throw std::runtime_error(inputFile + " could not be opened");
+  }
+  LandmarkTablesHeader header {};
+  infile.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!infile or std::memcmp(header.magic, landmarkTablesMagic,
+                             sizeof(header.magic)) != 0) {
+    throw std::runtime_error(inputFile + " does not hold landmark tables");
+  }
+  if (header.version != landmarkTablesVersion) {
+    throw std::runtime_error(inputFile + " has an unsupported landmark tables version");
+  }
+  if (header.weightSize != sizeof(T) or header.weightKind != binaryWeightKind<T>()) {
+    throw std::runtime_error(inputFile + " holds a different weight type");
+  }
+  // refuse sizes that cannot be right before allocating anything
+  infile.seekg(0, std::ios::end);
+  std::uint64_t fileSize = static_cast<std::uint64_t>(infile.tellg());
+  infile.seekg(sizeof(header));
+  std::uint64_t vertices = header.numVertices;
+  std::uint64_t k = header.numLandmarks;
+  if (vertices >= static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+      or k < 1 or k > vertices
+      or fileSize != sizeof(header) + sizeof(int) * k + 2 * sizeof(T) * vertices * k) {
+    throw std::runtime_error(inputFile + " is truncated or corrupt");
+  }
+  N = static_cast<int>(vertices);
+  landmarks_.resize(k);
+  fromLandmark.resize(vertices * k);
+  toLandmark.resize(vertices * k);
+  infile.read(reinterpret_cast<char*>(landmarks_.data()), sizeof(int) * k);
+  infile.read(reinterpret_cast<char*>(fromLandmark.data()),
+              sizeof(T) * fromLandmark.size());
+  infile.read(reinterpret_cast<char*>(toLandmark.data()),
+              sizeof(T) * toLandmark.size());
+  std::uint64_t hash = fnv1a(landmarks_.data(), sizeof(int) * landmarks_.size());
+  hash = fnv1a(fromLandmark.data(), sizeof(T) * fromLandmark.size(), hash);
+  hash = fnv1a(toLandmark.data(), sizeof(T) * toLandmark.size(), hash);
+  if (!infile or hash != header.checksum) {
+    throw std::runtime_error(inputFile + " is truncated or corrupt");
+  }
+  for (int landmark : landmarks_) {
+    if (landmark < 0 or landmark >= N) {
+      throw std::runtime_error(inputFile + " is truncated or corrupt");
+    }
+  }
+}
+
+#endif      // ALT_HPP_
@@ -0,0 +1,174 @@
+#ifndef ASTAR_HPP_
+#define ASTAR_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "coordinates.hpp"
+#include "dijkstra_workspace.hpp"
+#include "bidirectional_dijkstra.hpp"
+
+// A* is Dijkstra where a vertex v waits in the queue with priority
+// distance(v) + h(v), h(v) being a lower bound on the distance from v to
+// the target.  Vertices on the way to the target come out of the queue
+// first, so far fewer vertices are settled before the target is.
+//
+// A heuristic is anything callable as heuristic(v, target) returning a T.
+// It must be consistent, h(u) <= weight(u, v) + h(v) for every edge, which
+// makes the first time a vertex is settled final, as in Dijkstra.  The
+// heuristic [](int, int) { return T {}; } turns A* back into Dijkstra.
+
+// bound rounded down to a T, so it is still a lower bound
+template <typename T>
+T lowerBoundAs(double bound) {
+  if constexpr (std::is_same_v<T, MyInteger>) {
+    return MyInteger {static_cast<int>(std::floor(bound))};
+  } else if constexpr (std::is_integral_v<T>) {
+    return static_cast<T>(std::floor(bound));
+  } else {
+    return static_cast<T>(bound);
+  }
+}
+
+// distance between two vertices worked out from their positions
+using CoordinateMetric = double (*)(const VertexCoordinates&, int, int);
+
+// Largest factor s with s * metric(u, v) <= weight(u, v) for every edge.
+// Edge weights need not be in the units of the coordinates (road lengths
+// in the DIMACS data are not metres), and this factor converts between
+// them.  The metrics satisfy the triangle inequality, so s * metric(v,
+// target) is then a consistent heuristic.  It is 0 if no edge joins two
+// distinct positions.
+template <typename T, template <typename> class GraphType>
+double admissibleScale(const GraphType<T>& G,
+                       const VertexCoordinates& coordinates,
+                       CoordinateMetric metric) {
+  if (coordinates.size() != G.size()) {
+    throw std::invalid_argument("coordinates are for a different graph");
+  }
+  double scale = std::numeric_limits<double>::infinity();
+  for (int u = 0; u < G.size(); ++u) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(u))) {
+      double length = metric(coordinates, u, neighbour);
+      if (length > 0) {
+        scale = std::min(scale, asDouble(weight) / length);
+      }
+    }
+  }
+  if (scale == std::numeric_limits<double>::infinity()) {
+    return 0.0;
+  }
+  // leave room for rounding errors in the metric
+  return std::max(0.0, scale * (1 - 1e-9));
+}
+
+// heuristic scale * metric(v, target) for a graph with vertex positions
+template <typename T>
+class CoordinateHeuristic {
+ private:
+  const VertexCoordinates* coordinates {nullptr};
+  CoordinateMetric metric {nullptr};
+  double scale {};
+
+ public:
+  // coordinates must outlive the heuristic
+  CoordinateHeuristic(const VertexCoordinates& coordinates,
+                      CoordinateMetric metric, double scale);
+
+  T operator()(int v, int target) const;
+
+  double scaleFactor() const;
+};
+
+template <typename T>
+CoordinateHeuristic<T>::CoordinateHeuristic(const VertexCoordinates& coordinates,
+                                            CoordinateMetric metric,
+                                            double scale)
+    : coordinates {&coordinates}, metric {metric}, scale {scale} {}
+
+template <typename T>
+T CoordinateHeuristic<T>::operator()(int v, int target) const {
+  return lowerBoundAs<T>(scale * metric(*coordinates, v, target));
+}
+
+template <typename T>
+double CoordinateHeuristic<T>::scaleFactor() const {
+  return scale;
+}
+
+// straight line distance in the plane, for coordinates such as grid
+// positions.  Looks at every edge once to find the scale
+template <typename T, template <typename> class GraphType>
+CoordinateHeuristic<T> euclideanHeuristic(const GraphType<T>& G,
+                                          const VertexCoordinates& coordinates) {
+  return {coordinates, euclideanDistance,
+          admissibleScale(G, coordinates, euclideanDistance)};
+}
+
+// distance along the earth's surface, for longitudes and latitudes as in
+// the DIMACS road data.  Looks at every edge once to find the scale
+template <typename T, template <typename> class GraphType>
+CoordinateHeuristic<T> greatCircleHeuristic(const GraphType<T>& G,
+                                            const VertexCoordinates& coordinates) {
+  return {coordinates, greatCircleDistance,
+          admissibleScale(G, coordinates, greatCircleDistance)};
+}
+
+// A* from source to target.  The search keeps its state in workspace, so
+// afterwards workspace.settled() shows which vertices it had to settle.
+template <typename Heuristic, typename T, template <typename> class GraphType>
+PathAndLength<T> aStar(const GraphType<T>& G, int source, int target,
+                       const Heuristic& heuristic,
+                       DijkstraWorkspace<T>& workspace) {
+  if (source < 0 or source >= G.size() or target < 0 or target >= G.size()) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  workspace.reset();
+  IndexPriorityQueue<T>& queue = workspace.queue();
+  workspace.reach(source, T {}, -1);
+  queue.push(heuristic(source, target), source);
+  while (!queue.empty()) {
+    int current = queue.topIndex();
+    queue.pop();
+    workspace.settle(current);
+    if (current == target) {
+      break;
+    }
+    // relax all outgoing edges of current
+    for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
+      if (workspace.settled(neighbour)) {
+        continue;
+      }
+      T distanceViaCurrent = workspace.distance(current) + weight;
+      if (workspace.distance(neighbour) > distanceViaCurrent) {
+        workspace.reach(neighbour, std::move(distanceViaCurrent), current);
+        queue.changeKey(
+            workspace.distance(neighbour) + heuristic(neighbour, target),
+            neighbour);
+      }
+    }
+  }
+  PathAndLength<T> result {};
+  if (!workspace.settled(target)) {
+    result.length = infinity<T>();
+    return result;
+  }
+  result.length = workspace.distance(target);
+  result.path = workspace.pathTo(target);
+  return result;
+}
+
+// one off query, allocating the workspace for it
+template <typename Heuristic, typename T, template <typename> class GraphType>
+PathAndLength<T> aStar(const GraphType<T>& G, int source, int target,
+                       const Heuristic& heuristic) {
+  DijkstraWorkspace<T> workspace(G.size());
+  return aStar(G, source, target, heuristic, workspace);
+}
+
+#endif      // ASTAR_HPP_
@@ -0,0 +1,289 @@
+#ifndef BELLMAN_FORD_HPP_
+#define BELLMAN_FORD_HPP_
+
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "graph.hpp"
+#include "shortest_path_tree.hpp"
+#include "thread_pool.hpp"
+
+// Shortest paths when weights can be negative, where Dijkstra goes wrong:
+// it takes a vertex's distance as final when the vertex leaves the queue,
+// but a negative edge found later can still make it shorter.
+//
+// Bellman-Ford relaxes edges until nothing changes.  Without a negative
+// cycle that happens within N - 1 rounds.  A negative cycle reachable from
+// the source has no shortest paths at all, and then the result holds the
+// cycle instead as a certificate: negativeCycle lists its vertices so that
+// negativeCycle[i] -> negativeCycle[i + 1] and back.negativeCycle -> front
+// are edges whose weights add up to less than 0.
+
+template <typename T>
+struct NegativeWeightResult {
+  // distances and parents; only meaningful without a negative cycle
+  ShortestPathTree<T> tree;
+  // empty if no negative cycle can be reached from the source
+  std::vector<int> negativeCycle {};
+
+  bool hasNegativeCycle() const {
+    return !negativeCycle.empty();
+  }
+};
+
+namespace bellman_ford_detail {
+
+// the cycle through v in the parent array, in edge direction
+inline std::vector<int> cycleThrough(int v, const std::vector<int>& prev) {
+  std::vector<int> cycle {v};
+  for (int u = prev.at(v); u != v; u = prev.at(u)) {
+    cycle.push_back(u);
+  }
+  std::reverse(cycle.begin(), cycle.end());
+  return cycle;
+}
+
+// a cycle in the parent graph if there is one, empty otherwise
+inline std::vector<int> parentCycle(const std::vector<int>& prev) {
+  int N = static_cast<int>(prev.size());
+  // 0 not seen, 1 on the walk in progress, 2 seen on an earlier walk
+  std::vector<char> state(N);
+  for (int start = 0; start < N; ++start) {
+    int v = start;
+    while (v != -1 and state.at(v) == 0) {
+      state.at(v) = 1;
+      v = prev.at(v);
+    }
+    if (v != -1 and state.at(v) == 1) {
+      return cycleThrough(v, prev);
+    }
+    for (int u = start; u != -1 and state.at(u) == 1; u = prev.at(u)) {
+      state.at(u) = 2;
+    }
+  }
+  return {};
+}
+
+// cycle from parentCycle if its weight is negative, empty otherwise
+template <typename T>
+std::vector<int> negativeParentCycle(const std::vector<int>& prev,
+                                     const std::vector<T>& prevWeight) {
+  std::vector<int> cycle {parentCycle(prev)};
+  T weight {};
+  for (int v : cycle) {
+    weight = weight + prevWeight.at(v);
+  }
+  if (!(weight < T {})) {
+    cycle.clear();
+  }
+  return cycle;
+}
+
+}  // namespace bellman_ford_detail
+
+// The textbook certificate: N rounds of Bellman-Ford over all edges.  If a
+// distance still drops in the last round, going back N parents from that
+// vertex ends up on a negative cycle.  Empty if there is none reachable
+// from source.  Takes O(N E) time, so the engines below only fall back on
+// it once they know there is a cycle.
+template <typename T, template <typename> class GraphType>
+std::vector<int> negativeCycleFrom(const GraphType<T>& G, int source) {
+  int N = G.size();
+  if (source < 0 or source >= N) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  std::vector<T> bestDistanceTo(N, infinity<T>());
+  std::vector<int> prev(N, -1);
+  bestDistanceTo.at(source) = T {};
+  int lastRelaxed = -1;
+  for (int round = 0; round < N; ++round) {
+    lastRelaxed = -1;
+    for (int u = 0; u < N; ++u) {
+      if (bestDistanceTo.at(u) == infinity<T>()) {
+        continue;
+      }
+      for (const auto& [neighbour, weight] : *(G.neighbours(u))) {
+        T distanceViaU = bestDistanceTo.at(u) + weight;
+        if (distanceViaU < bestDistanceTo.at(neighbour)) {
+          bestDistanceTo.at(neighbour) = distanceViaU;
+          prev.at(neighbour) = u;
+          lastRelaxed = neighbour;
+        }
+      }
+    }
+    if (lastRelaxed == -1) {
+      return {};
+    }
+  }
+  int onCycle = lastRelaxed;
+  for (int step = 0; step < N; ++step) {
+    onCycle = prev.at(onCycle);
+  }
+  return bellman_ford_detail::cycleThrough(onCycle, prev);
+}
+
+// SPFA (queue-based Bellman-Ford): only vertices whose distance dropped
+// have their edges relaxed again, kept in a FIFO queue, so it stops as
+// soon as nothing changes and often does far less than N - 1 rounds.
+// Every N relaxations it looks for a negative cycle in the parent graph,
+// which finds most negative cycles early; a vertex queued N times proves
+// there is one even if the parents do not show it yet.
+template <typename T, template <typename> class GraphType>
+NegativeWeightResult<T> spfa(const GraphType<T>& G, int source) {
+  int N = G.size();
+  if (source < 0 or source >= N) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  std::vector<T> bestDistanceTo(N, infinity<T>());
+  std::vector<int> prev(N, -1);
+  std::vector<T> prevWeight(N);
+  std::vector<bool> inQueue(N);
+  std::vector<int> timesQueued(N);
+  std::deque<int> queue {source};
+  bestDistanceTo.at(source) = T {};
+  inQueue.at(source) = true;
+  long long relaxations = 0;
+  std::vector<int> cycle {};
+  while (!queue.empty() and cycle.empty()) {
+    int current = queue.front();
+    queue.pop_front();
+    inQueue.at(current) = false;
+    for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
+      T distanceViaCurrent = bestDistanceTo.at(current) + weight;
+      if (!(distanceViaCurrent < bestDistanceTo.at(neighbour))) {
+        continue;
+      }
+      bestDistanceTo.at(neighbour) = distanceViaCurrent;
+      prev.at(neighbour) = current;
+      prevWeight.at(neighbour) = weight;
+      if (++relaxations % N == 0) {
+        cycle = bellman_ford_detail::negativeParentCycle(prev, prevWeight);
+        if (!cycle.empty()) {
+          break;
+        }
+      }
+      if (!inQueue.at(neighbour)) {
+        if (++timesQueued.at(neighbour) == N) {
+          cycle = negativeCycleFrom(G, source);
+          if (!cycle.empty()) {
+            break;
+          }
+        }
+        inQueue.at(neighbour) = true;
+        queue.push_back(neighbour);
+      }
+    }
+  }
+  return {{source, std::move(prev), std::move(bestDistanceTo),
+           std::move(prevWeight)}, std::move(cycle)};
+}
+
+// Bellman-Ford in rounds on numThreads threads.  The edges are laid out
+// once in a contiguous array grouped by head vertex, and each round every
+// thread recomputes the distances of its own range of vertices from the
+// previous round's distances of their in-neighbours.  No two threads
+// write the same entry, so there are no locks or atomics in the inner
+// loop.  A vertex is only looked at if one of its in-neighbours changed in
+// the previous round, and the search stops with the first round that
+// changes nothing.  A change in round N means a negative cycle.
+// The thread count goes through effectiveThreads.
+template <typename T, template <typename> class GraphType>
+NegativeWeightResult<T> bellmanFord(const GraphType<T>& G, int source,
+                                    int numThreads = defaultThreadCount()) {
+  int N = G.size();
+  if (source < 0 or source >= N) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  numThreads = std::min(effectiveThreads<T>(numThreads), std::max(1, N));
+
+  // incoming edges of v are tails[inOffsets[v]], ..., tails[inOffsets[v + 1] - 1]
+  std::vector<int> inOffsets(N + 1);
+  for (int u = 0; u < N; ++u) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(u))) {
+      ++inOffsets.at(neighbour + 1);
+    }
+  }
+  for (int v = 0; v < N; ++v) {
+    inOffsets.at(v + 1) += inOffsets.at(v);
+  }
+  std::vector<int> tails(inOffsets.back());
+  std::vector<T> weights(inOffsets.back());
+  {
+    std::vector<int> next(inOffsets.begin(), inOffsets.end() - 1);
+    for (int u = 0; u < N; ++u) {
+      for (const auto& [neighbour, weight] : *(G.neighbours(u))) {
+        tails.at(next.at(neighbour)) = u;
+        weights.at(next.at(neighbour)) = weight;
+        ++next.at(neighbour);
+      }
+    }
+  }
+
+  std::vector<T> bestDistanceTo(N, infinity<T>());
+  std::vector<int> prev(N, -1);
+  std::vector<T> prevWeight(N);
+  bestDistanceTo.at(source) = T {};
+  std::vector<T> nextDistance {bestDistanceTo};
+  // changed.at(v) if v's distance dropped in the last round
+  std::vector<char> changed(N);
+  std::vector<char> changedNext(N);
+  changed.at(source) = 1;
+  std::vector<char> threadChanged(numThreads);
+  ThreadPool pool {numThreads};
+  bool anyChange = true;
+  int round = 0;
+  while (anyChange and round < N) {
+    ++round;
+    pool.run([&](int thread) {
+      int first = static_cast<int>(static_cast<long long>(N) * thread / numThreads);
+      int last = static_cast<int>(static_cast<long long>(N) * (thread + 1) / numThreads);
+      bool mine = false;
+      for (int v = first; v < last; ++v) {
+        T best = bestDistanceTo[v];
+        int bestTail = -1;
+        for (int e = inOffsets[v]; e < inOffsets[v + 1]; ++e) {
+          int u = tails[e];
+          if (!changed[u]) {
+            continue;
+          }
+          T distanceViaU = bestDistanceTo[u] + weights[e];
+          if (distanceViaU < best) {
+            best = distanceViaU;
+            bestTail = e;
+          }
+        }
+        changedNext[v] = bestTail != -1;
+        if (bestTail != -1) {
+          nextDistance[v] = best;
+          prev[v] = tails[bestTail];
+          prevWeight[v] = weights[bestTail];
+          mine = true;
+        }
+      }
+      threadChanged[thread] = mine;
+    });
+    anyChange = std::find(threadChanged.begin(), threadChanged.end(), 1)
+                != threadChanged.end();
+    for (int v = 0; v < N; ++v) {
+      if (changedNext[v]) {
+        bestDistanceTo[v] = nextDistance[v];
+      }
+    }
+    changed.swap(changedNext);
+  }
+
+  std::vector<int> cycle {};
+  if (anyChange) {
+    // still improving after N rounds
+    cycle = bellman_ford_detail::negativeParentCycle(prev, prevWeight);
+    if (cycle.empty()) {
+      cycle = negativeCycleFrom(G, source);
+    }
+  }
+  return {{source, std::move(prev), std::move(bestDistanceTo),
+           std::move(prevWeight)}, std::move(cycle)};
+}
+
+#endif      // BELLMAN_FORD_HPP_
@@ -0,0 +1,118 @@
+#ifndef BIDIRECTIONAL_DIJKSTRA_HPP_
+#define BIDIRECTIONAL_DIJKSTRA_HPP_
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "dijkstra_workspace.hpp"
+
+// Answer to a point to point query: the vertices of a shortest path from
+// source to target, both included, and its length.  If target cannot be
+// reached the path is empty and the length is infinity<T>().
+template <typename T>
+struct PathAndLength {
+  std::vector<int> path {};
+  T length {};
+};
+
+// Bidirectional Dijkstra: a forward search from source on G and a backward
+// search from target on G.reverse() take turns, each time settling the
+// smaller of the two queue minimums.  Whenever an edge joins a vertex
+// reached by one search to a vertex reached by the other, the path through
+// it is a candidate and the best candidate is kept.  Once the two queue
+// minimums add up to at least the best candidate no shorter path can be
+// found, which usually happens when the searches have covered two balls of
+// about half the distance each rather than one ball of the full distance.
+//
+// The searches keep their state in the two workspaces, so repeated queries
+// on a large graph allocate nothing and reset in O(touched).  Afterwards
+// forward holds distances from source and backward distances to target.
+// Needs G.reverse(); Graph<T>, CompactGraph<T> and MappedGraph<T> all
+// build it once and cache it.
+template <typename T, template <typename> class GraphType>
+PathAndLength<T> shortestPath(const GraphType<T>& G, int source, int target,
+                              DijkstraWorkspace<T>& forward,
+                              DijkstraWorkspace<T>& backward) {
+  int N = G.size();
+  if (source < 0 or source >= N or target < 0 or target >= N) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  const auto& R = G.reverse();
+  forward.reset();
+  backward.reset();
+  forward.reach(source, T {}, -1);
+  forward.queue().push(T {}, source);
+  backward.reach(target, T {}, -1);
+  backward.queue().push(T {}, target);
+  // best candidate so far goes through meeting, -1 if there is none yet
+  int meeting = -1;
+  T best = infinity<T>();
+  if (source == target) {
+    meeting = source;
+    best = T {};
+  }
+
+  // settle the next vertex of one search and relax its edges in graph
+  auto step = [&](const auto& graph, DijkstraWorkspace<T>& mine,
+                  const DijkstraWorkspace<T>& other) {
+    IndexPriorityQueue<T>& queue = mine.queue();
+    int current = queue.topIndex();
+    queue.pop();
+    mine.settle(current);
+    for (const auto& [neighbour, weight] : *(graph.neighbours(current))) {
+      T distanceViaCurrent = mine.distance(current) + weight;
+      if (!mine.settled(neighbour)
+          and mine.distance(neighbour) > distanceViaCurrent) {
+        mine.reach(neighbour, std::move(distanceViaCurrent), current);
+        queue.changeKey(mine.distance(neighbour), neighbour);
+      }
+      // a candidate even if neighbour is settled, the edge may be the
+      // one joining the two searches on a shortest path
+      if (other.reached(neighbour)) {
+        T throughNeighbour = mine.distance(neighbour) + other.distance(neighbour);
+        if (meeting == -1 or throughNeighbour < best) {
+          best = std::move(throughNeighbour);
+          meeting = neighbour;
+        }
+      }
+    }
+  };
+
+  while (!forward.queue().empty() and !backward.queue().empty()) {
+    const T& forwardMin = forward.queue().topKey();
+    const T& backwardMin = backward.queue().topKey();
+    if (meeting != -1 and !(forwardMin + backwardMin < best)) {
+      break;
+    }
+    if (backwardMin < forwardMin) {
+      step(R, backward, forward);
+    } else {
+      step(G, forward, backward);
+    }
+  }
+
+  PathAndLength<T> result {};
+  if (meeting == -1) {
+    result.length = infinity<T>();
+    return result;
+  }
+  // distances only go down, so these can be shorter than best was
+  // when meeting was found, never longer
+  result.length = forward.distance(meeting) + backward.distance(meeting);
+  result.path = forward.pathTo(meeting);
+  for (int v = backward.parent(meeting); v != -1; v = backward.parent(v)) {
+    result.path.push_back(v);
+  }
+  return result;
+}
+
+// one off query, allocating the workspaces for it
+template <typename T, template <typename> class GraphType>
+PathAndLength<T> shortestPath(const GraphType<T>& G, int source, int target) {
+  DijkstraWorkspace<T> forward(G.size());
+  DijkstraWorkspace<T> backward(G.size());
+  return shortestPath(G, source, target, forward, backward);
+}
+
+#endif      // BIDIRECTIONAL_DIJKSTRA_HPP_
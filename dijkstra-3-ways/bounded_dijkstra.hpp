@@ -0,0 +1,208 @@
+#ifndef BOUNDED_DIJKSTRA_HPP_
+#define BOUNDED_DIJKSTRA_HPP_
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "dijkstra_workspace.hpp"
+
+// Dijkstra searches that stop early and only return what they settled:
+//   - ...Within(G, source, radius) settles the vertices at distance at
+//     most radius, an isochrone
+//   - ...Until(G, source, targets) stops once every target is settled, as
+//     for the nearest of a few facilities; unreachable targets make it
+//     search everything reachable.
+// Both come with an index priority queue, through workspaceSearch, and with
+// a lazy std::priority_queue, like singleSourceLazy.  The arrays behind a
+// search live in a DijkstraWorkspace, which repeated queries should pass
+// in, so the cost of a query follows the size of the region it settles
+// rather than the size of the graph.
+
+// The vertices a search settled, in the order it settled them and so by
+// distance, with their distances and their parents on a shortest path
+// (-1 for the source).  The source always comes first.
+template <typename T>
+struct SettledRegion {
+  std::vector<int> vertices {};
+  std::vector<T> distances {};
+  std::vector<int> parents {};
+
+  int size() const {
+    return static_cast<int>(vertices.size());
+  }
+};
+
+namespace bounded_detail {
+
+// what makes a search stop, besides running out of vertices
+template <typename T>
+struct StopRule {
+  const T* radius {nullptr};
+  // sorted without repeats
+  std::vector<int> targets {};
+  bool hasTargets = false;
+};
+
+template <typename T>
+StopRule<T> stopAtRadius(const T& radius) {
+  return {&radius, {}, false};
+}
+
+template <typename T>
+StopRule<T> stopAtTargets(int N, const std::vector<int>& targets) {
+  StopRule<T> rule {nullptr, targets, true};
+  for (int target : targets) {
+    if (target < 0 or target >= N) {
+      throw std::out_of_range("invalid vertex number");
+    }
+  }
+  std::sort(rule.targets.begin(), rule.targets.end());
+  rule.targets.erase(std::unique(rule.targets.begin(), rule.targets.end()),
+                     rule.targets.end());
+  return rule;
+}
+
+// add current to region; returns whether the search is done
+template <typename T>
+bool settleInto(SettledRegion<T>& region, DijkstraWorkspace<T>& workspace,
+                int current, const T& dist, const StopRule<T>& rule,
+                int& targetsLeft) {
+  workspace.settle(current);
+  region.vertices.push_back(current);
+  region.distances.push_back(dist);
+  region.parents.push_back(workspace.parent(current));
+  if (rule.hasTargets and std::binary_search(rule.targets.begin(),
+                                             rule.targets.end(), current)) {
+    --targetsLeft;
+  }
+  return rule.hasTargets and targetsLeft == 0;
+}
+
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> indexSearch(const GraphType<T>& G, int source,
+                             DijkstraWorkspace<T>& workspace,
+                             const StopRule<T>& rule) {
+  SettledRegion<T> region {};
+  int targetsLeft = static_cast<int>(rule.targets.size());
+  workspaceSearch(G, source, workspace,
+                  [&rule](const T& dist) {
+                    return rule.radius != nullptr and *rule.radius < dist;
+                  },
+                  [&](int current, const T& dist) {
+                    return settleInto(region, workspace, current, dist, rule,
+                                      targetsLeft);
+                  });
+  return region;
+}
+
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> lazySearch(const GraphType<T>& G, int source,
+                            DijkstraWorkspace<T>& workspace,
+                            const StopRule<T>& rule) {
+  if (source < 0 or source >= G.size()) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  using DistAndVertex = std::pair<T, int>;
+  std::priority_queue<DistAndVertex, std::vector<DistAndVertex>,
+                      std::greater<DistAndVertex> > queue {};
+  SettledRegion<T> region {};
+  int targetsLeft = static_cast<int>(rule.targets.size());
+  workspace.reset();
+  workspace.reach(source, T {}, -1);
+  queue.push({T {}, source});
+  while (!queue.empty()) {
+    if (rule.radius != nullptr and *rule.radius < queue.top().first) {
+      break;
+    }
+    int current = queue.top().second;
+    queue.pop();
+    // lazy dijkstra: entries with an old distance are skipped
+    if (workspace.settled(current)) {
+      continue;
+    }
+    // an entry not skipped holds the distance in the workspace
+    const T& dist = workspace.distance(current);
+    if (settleInto(region, workspace, current, dist, rule, targetsLeft)) {
+      break;
+    }
+    // relax all outgoing edges of current
+    for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
+      T distanceViaCurrent = dist + weight;
+      if (workspace.distance(neighbour) > distanceViaCurrent) {
+        workspace.reach(neighbour, std::move(distanceViaCurrent), current);
+        queue.push({workspace.distance(neighbour), neighbour});
+      }
+    }
+  }
+  return region;
+}
+
+}  // namespace bounded_detail
+
+// vertices within radius of source, using the workspace
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> singleSourceIndexWithin(const GraphType<T>& G, int source,
+                                         const T& radius,
+                                         DijkstraWorkspace<T>& workspace) {
+  return bounded_detail::indexSearch(G, source, workspace,
+                                     bounded_detail::stopAtRadius(radius));
+}
+
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> singleSourceIndexWithin(const GraphType<T>& G, int source,
+                                         const T& radius) {
+  DijkstraWorkspace<T> workspace(G.size());
+  return singleSourceIndexWithin(G, source, radius, workspace);
+}
+
+// vertices up to the last of targets to be settled, using the workspace
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> singleSourceIndexUntil(const GraphType<T>& G, int source,
+                                        const std::vector<int>& targets,
+                                        DijkstraWorkspace<T>& workspace) {
+  return bounded_detail::indexSearch(
+      G, source, workspace, bounded_detail::stopAtTargets<T>(G.size(), targets));
+}
+
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> singleSourceIndexUntil(const GraphType<T>& G, int source,
+                                        const std::vector<int>& targets) {
+  DijkstraWorkspace<T> workspace(G.size());
+  return singleSourceIndexUntil(G, source, targets, workspace);
+}
+
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> singleSourceLazyWithin(const GraphType<T>& G, int source,
+                                        const T& radius,
+                                        DijkstraWorkspace<T>& workspace) {
+  return bounded_detail::lazySearch(G, source, workspace,
+                                    bounded_detail::stopAtRadius(radius));
+}
+
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> singleSourceLazyWithin(const GraphType<T>& G, int source,
+                                        const T& radius) {
+  DijkstraWorkspace<T> workspace(G.size());
+  return singleSourceLazyWithin(G, source, radius, workspace);
+}
+
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> singleSourceLazyUntil(const GraphType<T>& G, int source,
+                                       const std::vector<int>& targets,
+                                       DijkstraWorkspace<T>& workspace) {
+  return bounded_detail::lazySearch(
+      G, source, workspace, bounded_detail::stopAtTargets<T>(G.size(), targets));
+}
+
+template <typename T, template <typename> class GraphType>
+SettledRegion<T> singleSourceLazyUntil(const GraphType<T>& G, int source,
+                                       const std::vector<int>& targets) {
+  DijkstraWorkspace<T> workspace(G.size());
+  return singleSourceLazyUntil(G, source, targets, workspace);
+}
+
+#endif      // BOUNDED_DIJKSTRA_HPP_
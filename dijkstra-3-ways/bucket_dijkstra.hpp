@@ -0,0 +1,85 @@
+#ifndef BUCKET_DIJKSTRA_HPP_
+#define BUCKET_DIJKSTRA_HPP_
+
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "graph.hpp"
+
+// Dial's algorithm: Dijkstra for graphs whose weights are integers in
+// [0, MaxWeight].  Instead of a heap we keep MaxWeight + 1 buckets, where
+// bucket d % (MaxWeight + 1) holds the vertices with tentative distance d.
+// Every tentative distance in the queue lies within MaxWeight of the
+// distance being settled, so the buckets can be reused in a circle.
+// Pushes and pops are O(1) and no priorities are ever compared against
+// each other; the cost is one scan over MaxWeight + 1 buckets per unit of
+// the largest distance, so it is meant for small MaxWeight.
+//
+// Like lazy Dijkstra a vertex can sit in several buckets, entries whose
+// distance has since improved are skipped.
+template <int MaxWeight, typename T, template <typename> class GraphType>
+Graph<T> singleSourceDial(const GraphType<T>& G, int source) {
+  static_assert(std::is_integral_v<T>,
+                "Dial's algorithm needs integer edge weights");
+  static_assert(MaxWeight >= 0, "MaxWeight must not be negative");
+  constexpr int numBuckets = MaxWeight + 1;
+  int N = G.size();
+  std::vector<std::vector<int> > buckets(numBuckets);
+  std::vector<T> bestDistanceTo(N, infinity<T>());
+  std::vector<int> prev(N, -1);
+  std::vector<T> prevWeight(N);
+  // being in visited means we have already explored a vertex's neighbours
+  std::vector<bool> visited(N);
+  bestDistanceTo.at(source) = T {};
+  buckets.at(0).push_back(source);
+  long long inBuckets = 1;
+  for (T distance {}; inBuckets > 0; ++distance) {
+    std::vector<int>& bucket = buckets[distance % numBuckets];
+    // edges of weight 0 add to the bucket we are emptying, so
+    // keep going until it is really empty
+    while (!bucket.empty()) {
+      int current = bucket.back();
+      bucket.pop_back();
+      --inBuckets;
+      if (visited.at(current) or bestDistanceTo.at(current) != distance) {
+        continue;
+      }
+      visited.at(current) = true;
+      // relax all outgoing edges of current
+      for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
+        if (weight < 0 or weight > MaxWeight) {
+          throw std::out_of_range("edge weight outside [0, MaxWeight]");
+        }
+        T distanceViaCurrent = distance + weight;
+        if (bestDistanceTo.at(neighbour) > distanceViaCurrent) {
+          bestDistanceTo.at(neighbour) = distanceViaCurrent;
+          prev.at(neighbour) = current;
+          prevWeight.at(neighbour) = weight;
+          buckets[distanceViaCurrent % numBuckets].push_back(neighbour);
+          ++inBuckets;
+        }
+      }
+    }
+  }
+  Graph<T> shortestPath {N};
+  for (int i = 0; i < N; ++i) {
+    if (prev.at(i) != -1) {
+      shortestPath.addEdge(prev.at(i), i, prevWeight.at(i));
+    }
+  }
+  return shortestPath;
+}
+
+// Chooses the engine at compile time: Dial's algorithm when the weights
+// are integers known to lie in [0, MaxWeight], singleSourceIndex otherwise
+// (for example for double or MyInteger weights).
+template <int MaxWeight, typename T, template <typename> class GraphType>
+Graph<T> singleSourceBoundedWeights(const GraphType<T>& G, int source) {
+  if constexpr (std::is_integral_v<T>) {
+    return singleSourceDial<MaxWeight>(G, source);
+  } else {
+    return singleSourceIndex(G, source);
+  }
+}
+
+#endif      // BUCKET_DIJKSTRA_HPP_
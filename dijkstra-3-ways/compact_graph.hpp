@@ -0,0 +1,358 @@
+#ifndef COMPACT_GRAPH_HPP_
+#define COMPACT_GRAPH_HPP_
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "graph.hpp"
+#include "graph_reader.hpp"
+
+// The outgoing edges of one vertex in a compressed sparse row (CSR) graph.
+// Targets and weights live in two contiguous arrays, so iterating over
+// a vertex's neighbours walks memory in order instead of chasing hash nodes.
+// Dereferencing an iterator gives a pair (neighbour, weight) so the usual
+//   for (const auto& [neighbour, weight] : *(G.neighbours(v)))
+// loop works unchanged.
+template <typename T>
+class CompactEdgeRange {
+ public:
+  class iterator {
+   public:
+    iterator(const int* target, const T* weight)
+        : target_ {target}, weight_ {weight} {}
+
+    // weight is returned by reference so no copies of T are made
+    std::pair<int, const T&> operator*() const {
+      return {*target_, *weight_};
+    }
+
+    iterator& operator++() {
+      ++target_;
+      ++weight_;
+      return *this;
+    }
+
+    int target() const {
+      return *target_;
+    }
+
+    const T& weight() const {
+      return *weight_;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.target_ == b.target_;
+    }
+
+    friend bool operator!=(const iterator& a, const iterator& b) {
+      return a.target_ != b.target_;
+    }
+
+   private:
+    const int* target_ {};
+    const T* weight_ {};
+  };
+
+  CompactEdgeRange(const int* first, const int* last, const T* weights)
+      : first_ {first}, last_ {last}, weights_ {weights} {}
+
+  iterator begin() const {
+    return {first_, weights_};
+  }
+
+  iterator end() const {
+    return {last_, weights_ + (last_ - first_)};
+  }
+
+  bool empty() const {
+    return first_ == last_;
+  }
+
+  int size() const {
+    return static_cast<int>(last_ - first_);
+  }
+
+  // targets within a row are sorted, so lookup is a binary search
+  // returns end() if there is no edge to j
+  iterator find(int j) const {
+    const int* it = std::lower_bound(first_, last_, j);
+    if (it == last_ or *it != j) {
+      return end();
+    }
+    return {it, weights_ + (it - first_)};
+  }
+
+ private:
+  const int* first_ {};
+  const int* last_ {};
+  const T* weights_ {};
+};
+
+// Iterates over the rows (vertices) of a CSR graph.  Plays the role of
+// Graph<T>::iterator: *(G.neighbours(v)) is the range of edges out of v
+// and G.neighbours(v)->empty() tells if v has no outgoing edges.
+template <typename T>
+class CompactRowIterator {
+ public:
+  // operator-> has to return something with an operator-> of its own,
+  // as the row is built on the fly rather than stored
+  struct Arrow {
+    CompactEdgeRange<T> range;
+    const CompactEdgeRange<T>* operator->() const {
+      return &range;
+    }
+  };
+
+  CompactRowIterator(const int* offsets, const int* targets,
+                     const T* weights, int row)
+      : offsets_ {offsets}, targets_ {targets}, weights_ {weights},
+        row_ {row} {}
+
+  CompactEdgeRange<T> operator*() const {
+    return {targets_ + offsets_[row_], targets_ + offsets_[row_ + 1],
+            weights_ + offsets_[row_]};
+  }
+
+  Arrow operator->() const {
+    return {**this};
+  }
+
+  CompactRowIterator& operator++() {
+    ++row_;
+    return *this;
+  }
+
+  CompactRowIterator operator+(int n) const {
+    return {offsets_, targets_, weights_, row_ + n};
+  }
+
+  friend bool operator==(const CompactRowIterator& a,
+                         const CompactRowIterator& b) {
+    return a.row_ == b.row_ and a.offsets_ == b.offsets_;
+  }
+
+  friend bool operator!=(const CompactRowIterator& a,
+                         const CompactRowIterator& b) {
+    return not (a == b);
+  }
+
+ private:
+  const int* offsets_ {};
+  const int* targets_ {};
+  const T* weights_ {};
+  int row_ {};
+};
+
+// An immutable graph in compressed sparse row form.
+// The edges out of vertex v are
+//   targets[offsets[v]], ..., targets[offsets[v + 1] - 1]
+// with matching weights in the same positions of weights.
+// It has the same read-only interface as Graph<T>, so the shortest path
+// functions and checkers in graph.hpp can be run on it directly.
+template <typename T>
+class CompactGraph {
+ private:
+  std::vector<int> offsets {};
+  std::vector<int> targets {};
+  std::vector<T> weights {};
+  int numVertices {};
+  // the graph with every edge turned around, built by the first call to
+  // reverse()
+  mutable std::shared_ptr<const CompactGraph<T> > reversed {};
+
+ public:
+  // freeze a Graph<T> into CSR form
+  explicit CompactGraph(const Graph<T>& G);
+
+  // read an edge list file straight into CSR form, without
+  // building a Graph<T> first
+  explicit CompactGraph(const std::string& filename);
+
+  // is there an edge from vertex i to vertex j?
+  bool isEdge(int i, int j) const;
+
+  // return weight of edge from i to j
+  // will throw an exception if there is no edge from i to j
+  T getEdgeWeight(int i, int j) const;
+
+  // returns number of vertices in the graph
+  int size() const;
+
+  // returns number of edges in the graph
+  int numEdges() const;
+
+  // CSR form of G with an edge j -> i for every edge i -> j of G
+  template <template <typename> class GraphType>
+  static CompactGraph<T> reverseOf(const GraphType<T>& G);
+
+  // reverseOf(*this), built on the first call and kept.  The first call
+  // is not thread safe, make it before sharing the graph between threads
+  const CompactGraph<T>& reverse() const;
+
+  // raw CSR arrays, offsets has size() + 1 entries
+  const int* offsetData() const {
+    return offsets.data();
+  }
+
+  const int* targetData() const {
+    return targets.data();
+  }
+
+  const T* weightData() const {
+    return weights.data();
+  }
+
+  using iterator = CompactRowIterator<T>;
+
+  iterator begin() const {
+    return {offsets.data(), targets.data(), weights.data(), 0};
+  }
+
+  iterator end() const {
+    return {offsets.data(), targets.data(), weights.data(), numVertices};
+  }
+
+  // return iterator to a particular vertex
+  iterator neighbours(int a) const {
+    return begin() + a;
+  }
+
+ private:
+  CompactGraph() = default;
+
+  struct Edge {
+    int from;
+    int to;
+    T weight;
+  };
+
+  // lay out an edge list in CSR order.  Rows are sorted by target and
+  // repeated (from, to) pairs keep only their first weight, which is
+  // what Graph<T>::addEdge does as well.
+  void build(std::vector<Edge>& edges);
+};
+
+template <typename T>
+CompactGraph<T>::CompactGraph(const Graph<T>& G) : numVertices {G.size()} {
+  std::vector<Edge> edges {};
+  for (int i = 0; i < numVertices; ++i) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(i))) {
+      edges.push_back({i, neighbour, weight});
+    }
+  }
+  build(edges);
+}
+
+// the file can be in EWD or DIMACS format, see graph_reader.hpp
+template <typename T>
+CompactGraph<T>::CompactGraph(const std::string& inputFile) {
+  EdgeList edgeList {readEdgeList(inputFile)};
+  numVertices = edgeList.numVertices;
+  std::vector<Edge> edges {};
+  edges.reserve(edgeList.numEdges());
+  for (int e = 0; e < edgeList.numEdges(); ++e) {
+    edges.push_back({edgeList.from[e], edgeList.to[e],
+                     static_cast<T>(edgeList.weights[e])});
+  }
+  build(edges);
+}
+
+template <typename T>
+void CompactGraph<T>::build(std::vector<Edge>& edges) {
+  std::stable_sort(edges.begin(), edges.end(),
+                   [](const Edge& a, const Edge& b) {
+                     return a.from < b.from
+                            or (a.from == b.from and a.to < b.to);
+                   });
+  auto last = std::unique(edges.begin(), edges.end(),
+                          [](const Edge& a, const Edge& b) {
+                            return a.from == b.from and a.to == b.to;
+                          });
+  edges.erase(last, edges.end());
+
+  offsets.assign(numVertices + 1, 0);
+  targets.reserve(edges.size());
+  weights.reserve(edges.size());
+  for (const auto& edge : edges) {
+    ++offsets.at(edge.from + 1);
+    targets.push_back(edge.to);
+    weights.push_back(edge.weight);
+  }
+  // turn counts per vertex into starting positions
+  for (int v = 0; v < numVertices; ++v) {
+    offsets.at(v + 1) += offsets.at(v);
+  }
+}
+
+template <typename T>
+template <template <typename> class GraphType>
+CompactGraph<T> CompactGraph<T>::reverseOf(const GraphType<T>& G) {
+  CompactGraph<T> R {};
+  R.numVertices = G.size();
+  std::vector<Edge> edges {};
+  for (int i = 0; i < R.numVertices; ++i) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(i))) {
+      edges.push_back({neighbour, i, weight});
+    }
+  }
+  R.build(edges);
+  return R;
+}
+
+template <typename T>
+const CompactGraph<T>& CompactGraph<T>::reverse() const {
+  if (!reversed) {
+    reversed = std::make_shared<const CompactGraph<T> >(reverseOf(*this));
+  }
+  return *reversed;
+}
+
+template <typename T>
+int CompactGraph<T>::size() const {
+  return numVertices;
+}
+
+template <typename T>
+int CompactGraph<T>::numEdges() const {
+  return static_cast<int>(targets.size());
+}
+
+template <typename T>
+bool CompactGraph<T>::isEdge(int i, int j) const {
+  if (i >= 0 && i < numVertices && j >= 0 && j < numVertices) {
+    auto row = *neighbours(i);
+    return row.find(j) != row.end();
+  }
+  return false;
+}
+
+template <typename T>
+T CompactGraph<T>::getEdgeWeight(int i, int j) const {
+  if (i < 0 or i >= numVertices) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  auto row = *neighbours(i);
+  auto it = row.find(j);
+  if (it == row.end()) {
+    throw std::out_of_range("no edge between these vertices");
+  }
+  return it.weight();
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const CompactGraph<T>& G) {
+  for (int i = 0; i < G.size(); ++i) {
+    out << i << ':';
+    for (const auto& [neighbour, weight] : *(G.neighbours(i))) {
+      out << " (" << i << ", " << neighbour << ")[" << weight << ']';
+    }
+    out << '\n';
+  }
+  return out;
+}
+
+#endif      // COMPACT_GRAPH_HPP_
@@ -0,0 +1,647 @@
+#ifndef CONTRACTION_HIERARCHY_HPP_
+#define CONTRACTION_HIERARCHY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "graph_binary.hpp"
+#include "dijkstra_workspace.hpp"
+#include "bidirectional_dijkstra.hpp"
+#include "thread_pool.hpp"
+
+// Contraction Hierarchies (Geisberger, Sanders, Schultes and Delling).
+//
+// Preprocessing removes ("contracts") the vertices one at a time.  Taking
+// v out of the graph, every path x -> v -> y that might be a shortest path
+// is replaced by a shortcut edge x -> y, unless a witness search finds a
+// path from x to y avoiding v that is no longer.  The order of removal is
+// the rank of a vertex.  Afterwards each vertex keeps its edges, original
+// or shortcut, to vertices of higher rank.
+//
+// Every shortest path then has a version that first only goes up in rank
+// and then only goes down, so a query runs a forward search from s over
+// upward edges and a backward search from t over downward edges.  Each of
+// them only sees a small part of the graph near the top of the hierarchy.
+// Shortcuts remember the vertex they skip, so paths can be unpacked again.
+//
+// Vertices are contracted in rounds.  Each round takes all vertices whose
+// priority is lower than that of each of their neighbours, simulates
+// their contractions in parallel and then applies them.  Since no two of
+// them are neighbours their shortcuts do not interfere, and their witness
+// searches avoid every vertex of the round so that no witness relies on a
+// vertex removed at the same time.
+
+namespace contraction_detail {
+
+// an edge of the graph still being contracted.  middle is the vertex a
+// shortcut skips, -1 for an original edge
+template <typename T>
+struct Arc {
+  T weight;
+  int middle;
+};
+
+template <typename T>
+struct Shortcut {
+  int from;
+  int to;
+  T weight;
+};
+
+// a witness search gives up after settling this many vertices and the
+// shortcut is added anyway.  Extra shortcuts never give wrong answers.
+constexpr int witnessSettleLimit = 500;
+
+// the remaining graph and the contraction state
+template <typename T>
+class Contractor {
+ public:
+  std::vector<std::unordered_map<int, Arc<T> > > out {};
+  std::vector<std::unordered_map<int, Arc<T> > > in {};
+  std::vector<int> priority {};
+  std::vector<int> contractedNeighbours {};
+  std::vector<int> level {};
+  // vertices of the round being contracted
+  std::vector<char> inRound {};
+
+  template <template <typename> class GraphType>
+  explicit Contractor(const GraphType<T>& G);
+
+  // shortcuts needed if v were contracted now, found with workspace
+  void simulate(int v, DijkstraWorkspace<T>& workspace,
+                std::vector<Shortcut<T> >& shortcuts) const;
+
+  // priority of v given the shortcuts contracting it needs:
+  // vertices that add few edges go first, spread out over the graph
+  int priorityOf(int v, const std::vector<Shortcut<T> >& shortcuts) const;
+
+  // does v go before its neighbour u?
+  bool before(int v, int u) const;
+};
+
+template <typename T>
+template <template <typename> class GraphType>
+Contractor<T>::Contractor(const GraphType<T>& G)
+    : out(G.size()), in(G.size()), priority(G.size()),
+      contractedNeighbours(G.size()), level(G.size()), inRound(G.size()) {
+  for (int u = 0; u < G.size(); ++u) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(u))) {
+      if (neighbour == u) {
+        continue;
+      }
+      auto found = out[u].find(neighbour);
+      if (found == out[u].end() or weight < found->second.weight) {
+        out[u][neighbour] = Arc<T> {weight, -1};
+        in[neighbour][u] = Arc<T> {weight, -1};
+      }
+    }
+  }
+}
+
+template <typename T>
+void Contractor<T>::simulate(int v, DijkstraWorkspace<T>& workspace,
+                             std::vector<Shortcut<T> >& shortcuts) const {
+  shortcuts.clear();
+  for (const auto& [x, inArc] : in[v]) {
+    // longest path through v the witness search has to beat
+    int targetsLeft = 0;
+    T bound {};
+    for (const auto& [y, outArc] : out[v]) {
+      if (y != x) {
+        T viaV = inArc.weight + outArc.weight;
+        if (targetsLeft == 0 or bound < viaV) {
+          bound = viaV;
+        }
+        ++targetsLeft;
+      }
+    }
+    if (targetsLeft == 0) {
+      continue;
+    }
+    // Dijkstra from x in the remaining graph without v and the round
+    workspace.reset();
+    IndexPriorityQueue<T>& queue = workspace.queue();
+    workspace.reach(x, T {}, -1);
+    queue.push(T {}, x);
+    int settled = 0;
+    while (!queue.empty() and settled < witnessSettleLimit) {
+      int current = queue.topIndex();
+      // the queue holds the same distance as the workspace
+      const T& dist = workspace.distance(current);
+      if (bound < dist) {
+        break;
+      }
+      queue.pop();
+      workspace.settle(current);
+      ++settled;
+      // stop once every target has its final distance
+      if (current != x and out[v].contains(current) and --targetsLeft == 0) {
+        break;
+      }
+      for (const auto& [neighbour, arc] : out[current]) {
+        if (neighbour == v or inRound[neighbour] or workspace.settled(neighbour)) {
+          continue;
+        }
+        T distanceViaCurrent = dist + arc.weight;
+        if (workspace.distance(neighbour) > distanceViaCurrent) {
+          workspace.reach(neighbour, std::move(distanceViaCurrent), current);
+          queue.changeKey(workspace.distance(neighbour), neighbour);
+        }
+      }
+    }
+    for (const auto& [y, outArc] : out[v]) {
+      if (y == x) {
+        continue;
+      }
+      T viaV = inArc.weight + outArc.weight;
+      // any path found, settled or not, avoids v
+      if (!workspace.reached(y) or viaV < workspace.distance(y)) {
+        shortcuts.push_back({x, y, viaV});
+      }
+    }
+  }
+}
+
+template <typename T>
+int Contractor<T>::priorityOf(int v, const std::vector<Shortcut<T> >& shortcuts) const {
+  int edgeDifference = static_cast<int>(shortcuts.size())
+                       - static_cast<int>(in[v].size() + out[v].size());
+  return 2 * edgeDifference + contractedNeighbours[v] + level[v];
+}
+
+template <typename T>
+bool Contractor<T>::before(int v, int u) const {
+  return priority[v] < priority[u] or (priority[v] == priority[u] and v < u);
+}
+
+}  // namespace contraction_detail
+
+// header of a saved hierarchy, laid out like BinaryGraphHeader
+struct ContractionHierarchyHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t weightSize;
+  std::uint32_t weightKind;
+  std::uint32_t reserved;      // written as zero
+  std::uint64_t numVertices;
+  std::uint64_t numUpArcs;
+  std::uint64_t numDownArcs;
+  std::uint64_t checksum;
+  std::uint64_t unused;        // written as zero, pads the header to 64 bytes
+};
+
+static_assert(sizeof(ContractionHierarchyHeader) == 64);
+
+inline constexpr char contractionHierarchyMagic[8] {'I', 'P', 'Q', 'C', 'H', 'I', 'E', 'R'};
+inline constexpr std::uint32_t contractionHierarchyVersion = 1;
+
+template <typename T>
+class ContractionHierarchy {
+ private:
+  std::vector<int> rank_ {};
+  // upward arcs v -> target with rank target > rank v, in CSR form
+  std::vector<int> upOffsets {};
+  std::vector<int> upTargets {};
+  std::vector<T> upWeights {};
+  std::vector<int> upMiddles {};
+  // downward arcs source -> v with rank source > rank v, stored at v
+  std::vector<int> downOffsets {};
+  std::vector<int> downSources {};
+  std::vector<T> downWeights {};
+  std::vector<int> downMiddles {};
+
+ public:
+  // contract any graph with the read-only interface of Graph<T>.  Weights
+  // must not be negative.  numThreads goes through effectiveThreads
+  template <template <typename> class GraphType>
+  explicit ContractionHierarchy(const GraphType<T>& G,
+                                int numThreads = defaultThreadCount());
+
+  // load a hierarchy written by save(), throws std::runtime_error if the
+  // file is not one or was saved with a different weight type
+  explicit ContractionHierarchy(const std::string& filename);
+
+  void save(const std::string& filename) const;
+
+  // number of vertices
+  int size() const;
+
+  // position of v in the contraction order
+  int rank(int v) const;
+
+  // number of arcs in the hierarchy that are shortcuts
+  int numShortcuts() const;
+
+  // shortest path from source to target, unpacked into original edges.
+  // The searches keep their state in the workspaces, so repeated queries
+  // allocate nothing.  Thread safe given a pair of workspaces per thread
+  PathAndLength<T> query(int source, int target, DijkstraWorkspace<T>& forward,
+                         DijkstraWorkspace<T>& backward) const;
+
+  // one off query, allocating the workspaces for it
+  PathAndLength<T> query(int source, int target) const;
+
+ private:
+  // the vertex skipped by arc from -> to, -1 for an original edge
+  int middleOf(int from, int to) const;
+
+  // append the original path for arc from -> to, without from
+  void unpack(int from, int to, std::vector<int>& path) const;
+};
+
+template <typename T>
+template <template <typename> class GraphType>
+ContractionHierarchy<T>::ContractionHierarchy(const GraphType<T>& G,
+                                              int numThreads) {
+  using namespace contraction_detail;
+  int N = G.size();
+  numThreads = effectiveThreads<T>(numThreads);
+  Contractor<T> contractor {G};
+  ThreadPool pool {numThreads};
+  std::vector<DijkstraWorkspace<T> > workspaces {};
+  std::vector<std::vector<Shortcut<T> > > scratch(numThreads);
+  for (int t = 0; t < numThreads; ++t) {
+    workspaces.emplace_back(N);
+  }
+  // work out the priorities of vertices, split between the threads
+  auto updatePriorities = [&](const std::vector<int>& vertices) {
+    pool.run([&](int t) {
+      for (std::size_t i = t; i < vertices.size(); i += numThreads) {
+        int v = vertices[i];
+        contractor.simulate(v, workspaces[t], scratch[t]);
+        contractor.priority[v] = contractor.priorityOf(v, scratch[t]);
+      }
+    });
+  };
+
+  std::vector<int> remaining(N);
+  for (int v = 0; v < N; ++v) {
+    remaining[v] = v;
+  }
+  updatePriorities(remaining);
+
+  rank_.assign(N, -1);
+  // final arcs of each vertex, collected as the vertices are contracted
+  std::vector<std::vector<std::pair<int, Arc<T> > > > up(N);
+  std::vector<std::vector<std::pair<int, Arc<T> > > > down(N);
+  std::vector<std::vector<Shortcut<T> > > roundShortcuts {};
+  std::vector<int> round {};
+  std::vector<int> touched {};
+  std::vector<char> isTouched(N);
+  int nextRank = 0;
+  while (!remaining.empty()) {
+    round.clear();
+    for (int v : remaining) {
+      bool lowest = true;
+      for (const auto& [u, arc] : contractor.out[v]) {
+        lowest = lowest and contractor.before(v, u);
+      }
+      for (const auto& [u, arc] : contractor.in[v]) {
+        lowest = lowest and contractor.before(v, u);
+      }
+      if (lowest) {
+        round.push_back(v);
+        contractor.inRound[v] = true;
+      }
+    }
+
+    roundShortcuts.assign(round.size(), {});
+    pool.run([&](int t) {
+      for (std::size_t i = t; i < round.size(); i += numThreads) {
+        contractor.simulate(round[i], workspaces[t], roundShortcuts[i]);
+      }
+    });
+
+    touched.clear();
+    for (std::size_t i = 0; i < round.size(); ++i) {
+      int v = round[i];
+      rank_[v] = nextRank++;
+      std::size_t firstNeighbour = touched.size();
+      for (const Shortcut<T>& shortcut : roundShortcuts[i]) {
+        auto& arcs = contractor.out[shortcut.from];
+        auto found = arcs.find(shortcut.to);
+        if (found == arcs.end() or shortcut.weight < found->second.weight) {
+          arcs[shortcut.to] = Arc<T> {shortcut.weight, v};
+          contractor.in[shortcut.to][shortcut.from] = Arc<T> {shortcut.weight, v};
+        }
+      }
+      for (const auto& [y, arc] : contractor.out[v]) {
+        up[v].push_back({y, arc});
+        contractor.in[y].erase(v);
+        touched.push_back(y);
+      }
+      for (const auto& [x, arc] : contractor.in[v]) {
+        down[v].push_back({x, arc});
+        contractor.out[x].erase(v);
+        touched.push_back(x);
+      }
+      for (std::size_t j = firstNeighbour; j < touched.size(); ++j) {
+        int u = touched[j];
+        ++contractor.contractedNeighbours[u];
+        contractor.level[u] = std::max(contractor.level[u], contractor.level[v] + 1);
+      }
+      contractor.out[v].clear();
+      contractor.in[v].clear();
+    }
+    for (int v : round) {
+      contractor.inRound[v] = false;
+    }
+
+    // neighbours of the round lost an edge and may have gained shortcuts
+    std::size_t kept = 0;
+    for (int u : touched) {
+      if (!isTouched[u]) {
+        isTouched[u] = true;
+        touched[kept++] = u;
+      }
+    }
+    touched.resize(kept);
+    for (int u : touched) {
+      isTouched[u] = false;
+    }
+    updatePriorities(touched);
+    remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+                                   [&](int v) { return rank_[v] != -1; }),
+                    remaining.end());
+  }
+
+  // lay the arcs out in CSR form
+  upOffsets.assign(N + 1, 0);
+  downOffsets.assign(N + 1, 0);
+  for (int v = 0; v < N; ++v) {
+    for (const auto& [target, arc] : up[v]) {
+      upTargets.push_back(target);
+      upWeights.push_back(arc.weight);
+      upMiddles.push_back(arc.middle);
+    }
+    upOffsets[v + 1] = static_cast<int>(upTargets.size());
+    for (const auto& [source, arc] : down[v]) {
+      downSources.push_back(source);
+      downWeights.push_back(arc.weight);
+      downMiddles.push_back(arc.middle);
+    }
+    downOffsets[v + 1] = static_cast<int>(downSources.size());
+    std::vector<std::pair<int, Arc<T> > > {}.swap(up[v]);
+    std::vector<std::pair<int, Arc<T> > > {}.swap(down[v]);
+  }
+}
+
+template <typename T>
+int ContractionHierarchy<T>::size() const {
+  return static_cast<int>(rank_.size());
+}
+
+template <typename T>
+int ContractionHierarchy<T>::rank(int v) const {
+  return rank_.at(v);
+}
+
+template <typename T>
+int ContractionHierarchy<T>::numShortcuts() const {
+  return static_cast<int>(
+      std::count_if(upMiddles.begin(), upMiddles.end(), [](int m) { return m != -1; })
+      + std::count_if(downMiddles.begin(), downMiddles.end(), [](int m) { return m != -1; }));
+}
+
+template <typename T>
+PathAndLength<T> ContractionHierarchy<T>::query(int source, int target,
+                                                DijkstraWorkspace<T>& forward,
+                                                DijkstraWorkspace<T>& backward) const {
+  int N = size();
+  if (source < 0 or source >= N or target < 0 or target >= N) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  forward.reset();
+  backward.reset();
+  forward.reach(source, T {}, -1);
+  forward.queue().push(T {}, source);
+  backward.reach(target, T {}, -1);
+  backward.queue().push(T {}, target);
+  int meeting = -1;
+  T best = infinity<T>();
+  if (source == target) {
+    meeting = source;
+    best = T {};
+  }
+
+  // settle the next vertex of one search and relax its arcs
+  auto step = [&](const std::vector<int>& offsets, const std::vector<int>& heads,
+                  const std::vector<T>& weights, DijkstraWorkspace<T>& mine,
+                  const DijkstraWorkspace<T>& other) {
+    IndexPriorityQueue<T>& queue = mine.queue();
+    int current = queue.topIndex();
+    queue.pop();
+    mine.settle(current);
+    for (int a = offsets[current]; a < offsets[current + 1]; ++a) {
+      int neighbour = heads[a];
+      T distanceViaCurrent = mine.distance(current) + weights[a];
+      if (mine.distance(neighbour) > distanceViaCurrent) {
+        mine.reach(neighbour, std::move(distanceViaCurrent), current);
+        queue.changeKey(mine.distance(neighbour), neighbour);
+      }
+      if (other.reached(neighbour)) {
+        T throughNeighbour = mine.distance(neighbour) + other.distance(neighbour);
+        if (meeting == -1 or throughNeighbour < best) {
+          best = std::move(throughNeighbour);
+          meeting = neighbour;
+        }
+      }
+    }
+  };
+  // a search is done once its queue is empty or cannot beat best
+  auto active = [&](DijkstraWorkspace<T>& search) {
+    return !search.queue().empty()
+           and (meeting == -1 or search.queue().topKey() < best);
+  };
+
+  while (true) {
+    bool forwardActive = active(forward);
+    bool backwardActive = active(backward);
+    if (!forwardActive and !backwardActive) {
+      break;
+    }
+    if (forwardActive and (!backwardActive
+        or !(backward.queue().topKey() < forward.queue().topKey()))) {
+      step(upOffsets, upTargets, upWeights, forward, backward);
+    } else {
+      step(downOffsets, downSources, downWeights, backward, forward);
+    }
+  }
+
+  PathAndLength<T> result {};
+  if (meeting == -1) {
+    result.length = infinity<T>();
+    return result;
+  }
+  result.length = forward.distance(meeting) + backward.distance(meeting);
+  std::vector<int> hierarchyPath {forward.pathTo(meeting)};
+  for (int v = backward.parent(meeting); v != -1; v = backward.parent(v)) {
+    hierarchyPath.push_back(v);
+  }
+  result.path.push_back(source);
+  for (std::size_t i = 1; i < hierarchyPath.size(); ++i) {
+    unpack(hierarchyPath[i - 1], hierarchyPath[i], result.path);
+  }
+  return result;
+}
+
+template <typename T>
+PathAndLength<T> ContractionHierarchy<T>::query(int source, int target) const {
+  DijkstraWorkspace<T> forward(size());
+  DijkstraWorkspace<T> backward(size());
+  return query(source, target, forward, backward);
+}
+
+template <typename T>
+int ContractionHierarchy<T>::middleOf(int from, int to) const {
+  // the arc is kept at the lower ranked of its two ends
+  if (rank_[from] < rank_[to]) {
+    for (int a = upOffsets[from]; a < upOffsets[from + 1]; ++a) {
+      if (upTargets[a] == to) {
+        return upMiddles[a];
+      }
+    }
+  } else {
+    for (int a = downOffsets[to]; a < downOffsets[to + 1]; ++a) {
+      if (downSources[a] == from) {
+        return downMiddles[a];
+      }
+    }
+  }
+  throw std::logic_error("arc missing from contraction hierarchy");
+}
+
+template <typename T>
+void ContractionHierarchy<T>::unpack(int from, int to, std::vector<int>& path) const {
+  // arcs still to unpack, the next one on top
+  std::vector<std::pair<int, int> > arcs {{from, to}};
+  while (!arcs.empty()) {
+    auto [a, b] = arcs.back();
+    arcs.pop_back();
+    int middle = middleOf(a, b);
+    if (middle == -1) {
+      path.push_back(b);
+    } else {
+      arcs.push_back({middle, b});
+      arcs.push_back({a, middle});
+    }
+  }
+}
+
+template <typename T>
+void ContractionHierarchy<T>::save(const std::string& outputFile) const {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "saved hierarchies need a trivially copyable weight type");
+  ContractionHierarchyHeader header {};
+  std::memcpy(header.magic, contractionHierarchyMagic, sizeof(header.magic));
+  header.version = contractionHierarchyVersion;
+  header.weightSize = sizeof(T);
+  header.weightKind = binaryWeightKind<T>();
+  header.numVertices = rank_.size();
+  header.numUpArcs = upTargets.size();
+  header.numDownArcs = downSources.size();
+  // the arrays in the order they are written
+  std::vector<std::pair<const void*, std::size_t> > blocks {
+    {rank_.data(), sizeof(int) * rank_.size()},
+    {upOffsets.data(), sizeof(int) * upOffsets.size()},
+    {upTargets.data(), sizeof(int) * upTargets.size()},
+    {upMiddles.data(), sizeof(int) * upMiddles.size()},
+    {upWeights.data(), sizeof(T) * upWeights.size()},
+    {downOffsets.data(), sizeof(int) * downOffsets.size()},
+    {downSources.data(), sizeof(int) * downSources.size()},
+    {downMiddles.data(), sizeof(int) * downMiddles.size()},
+    {downWeights.data(), sizeof(T) * downWeights.size()},
+  };
+  std::uint64_t hash = fnv1a(nullptr, 0);
+  for (const auto& [data, length] : blocks) {
+    hash = fnv1a(data, length, hash);
+  }
+  header.checksum = hash;
+
+  std::ofstream outfile {outputFile, std::ios::binary | std::ios::trunc};
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be opened for writing");
+  }
+  outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const auto& [data, length] : blocks) {
+    outfile.write(static_cast<const char*>(data), length);
+  }
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be written");
+  }
+}
+
+template <typename T>
+ContractionHierarchy<T>::ContractionHierarchy(const std::string& inputFile) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "saved hierarchies need a trivially copyable weight type");
+  std::ifstream infile {inputFile, std::ios::binary};
+  if (!infile) {
+    throw std::runtime_error(inputFile + " could not be opened");
+  }
+  ContractionHierarchyHeader header {};
+  infile.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!infile or std::memcmp(header.magic, contractionHierarchyMagic,
+                             sizeof(header.magic)) != 0) {
+    throw std::runtime_error(inputFile + " is not a contraction hierarchy");
+  }
+  if (header.version != contractionHierarchyVersion) {
+    throw std::runtime_error(inputFile + " has an unsupported contraction hierarchy version");
+  }
+  if (header.weightSize != sizeof(T) or header.weightKind != binaryWeightKind<T>()) {
+    throw std::runtime_error(inputFile + " holds a different weight type");
+  }
+  // refuse sizes that cannot be right before allocating anything
+  infile.seekg(0, std::ios::end);
+  std::uint64_t fileSize = static_cast<std::uint64_t>(infile.tellg());
+  infile.seekg(sizeof(header));
+  std::uint64_t N = header.numVertices;
+  std::uint64_t up = header.numUpArcs;
+  std::uint64_t down = header.numDownArcs;
+  if (N >= static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+      or up > static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+      or down > static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+      or fileSize != sizeof(header) + sizeof(int) * (N + 2 * (N + 1) + 2 * up + 2 * down)
+                     + sizeof(T) * (up + down)) {
+    throw std::runtime_error(inputFile + " is truncated or corrupt");
+  }
+  rank_.resize(N);
+  upOffsets.resize(N + 1);
+  upTargets.resize(up);
+  upMiddles.resize(up);
+  upWeights.resize(up);
+  downOffsets.resize(N + 1);
+  downSources.resize(down);
+  downMiddles.resize(down);
+  downWeights.resize(down);
+  std::vector<std::pair<void*, std::size_t> > blocks {
+    {rank_.data(), sizeof(int) * rank_.size()},
+    {upOffsets.data(), sizeof(int) * upOffsets.size()},
+    {upTargets.data(), sizeof(int) * upTargets.size()},
+    {upMiddles.data(), sizeof(int) * upMiddles.size()},
+    {upWeights.data(), sizeof(T) * upWeights.size()},
+    {downOffsets.data(), sizeof(int) * downOffsets.size()},
+    {downSources.data(), sizeof(int) * downSources.size()},
+    {downMiddles.data(), sizeof(int) * downMiddles.size()},
+    {downWeights.data(), sizeof(T) * downWeights.size()},
+  };
+  std::uint64_t hash = fnv1a(nullptr, 0);
+  for (const auto& [data, length] : blocks) {
+    infile.read(static_cast<char*>(data), length);
+    hash = fnv1a(data, length, hash);
+  }
+  if (!infile or hash != header.checksum) {
+    throw std::runtime_error(inputFile + " is truncated or corrupt");
+  }
+}
+
+#endif      // CONTRACTION_HIERARCHY_HPP_
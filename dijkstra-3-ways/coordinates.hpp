@@ -0,0 +1,114 @@
+#ifndef COORDINATES_HPP_
+#define COORDINATES_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graph_reader.hpp"
+
+// Positions of the vertices of a graph, kept apart from the graph itself
+// since most graphs have none.  They are read from DIMACS coordinate files,
+// which come with the DIMACS road graphs (USA-road-d.NY.co goes with
+// USA-road-d.NY.gr): "c" lines are comments, a "p aux sp co N" line gives
+// the number of vertices and every "v id x y" line is the position of a
+// 1-based vertex.  In the road data x is the longitude and y the latitude,
+// both in millionths of a degree.
+struct VertexCoordinates {
+  std::vector<double> x {};
+  std::vector<double> y {};
+
+  int size() const {
+    return static_cast<int>(x.size());
+  }
+};
+
+// parse a coordinate file already in memory
+inline VertexCoordinates parseCoordinates(const char* p, const char* end) {
+  using namespace graph_reader_detail;
+  VertexCoordinates coordinates {};
+  while (p < end) {
+    skipSpaces(p, end);
+    if (p < end and *p == 'v') {
+      ++p;
+      long long id {};
+      double x {};
+      double y {};
+      if (parseInt(p, end, id) and parseNumber(p, end, x)
+          and parseNumber(p, end, y)) {
+        // vertices are numbered from 1
+        if (id < 1 or id > coordinates.size()) {
+          throw std::out_of_range("invalid vertex number");
+        }
+        coordinates.x[id - 1] = x;
+        coordinates.y[id - 1] = y;
+      }
+    } else if (p < end and *p == 'p') {
+      // "p aux sp co N": skip the three words before N
+      ++p;
+      for (int word = 0; word < 3; ++word) {
+        skipSpaces(p, end);
+        while (p < end and not isSpace(*p) and *p != '\n') {
+          ++p;
+        }
+      }
+      long long n {};
+      if (parseInt(p, end, n)) {
+        coordinates.x.assign(n, 0.0);
+        coordinates.y.assign(n, 0.0);
+      }
+    }
+    skipLine(p, end);
+  }
+  return coordinates;
+}
+
+// read a DIMACS coordinate file
+// if the file cannot be opened no coordinates are returned
+inline VertexCoordinates readCoordinates(const std::string& inputFile) {
+  std::FILE* file = std::fopen(inputFile.c_str(), "rb");
+  if (file == nullptr) {
+    std::cerr << inputFile << " could not be opened\n";
+    return VertexCoordinates {};
+  }
+  std::vector<char> buffer {};
+  std::fseek(file, 0, SEEK_END);
+  long length = std::ftell(file);
+  std::fseek(file, 0, SEEK_SET);
+  if (length > 0) {
+    buffer.resize(length);
+    buffer.resize(std::fread(buffer.data(), 1, length, file));
+  }
+  std::fclose(file);
+  return parseCoordinates(buffer.data(), buffer.data() + buffer.size());
+}
+
+// straight line distance between u and v in coordinate units
+inline double euclideanDistance(const VertexCoordinates& coordinates,
+                                int u, int v) {
+  return std::hypot(coordinates.x[u] - coordinates.x[v],
+                    coordinates.y[u] - coordinates.y[v]);
+}
+
+// distance in metres along the surface of the earth between u and v,
+// for coordinates in millionths of a degree as in the DIMACS files
+inline double greatCircleDistance(const VertexCoordinates& coordinates,
+                                  int u, int v) {
+  constexpr double earthRadius = 6371000.0;
+  constexpr double toRadians = 3.14159265358979323846 / 180.0 / 1e6;
+  double latitudeU = coordinates.y[u] * toRadians;
+  double latitudeV = coordinates.y[v] * toRadians;
+  double sinHalfLatitude = std::sin((latitudeV - latitudeU) / 2);
+  double sinHalfLongitude = std::sin((coordinates.x[v] - coordinates.x[u])
+                                     * toRadians / 2);
+  // haversine formula, which stays accurate for nearby points
+  double a = sinHalfLatitude * sinHalfLatitude
+             + std::cos(latitudeU) * std::cos(latitudeV)
+               * sinHalfLongitude * sinHalfLongitude;
+  return 2 * earthRadius * std::asin(std::sqrt(std::min(1.0, a)));
+}
+
+#endif      // COORDINATES_HPP_
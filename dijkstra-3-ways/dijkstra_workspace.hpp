@@ -0,0 +1,242 @@
+#ifndef DIJKSTRA_WORKSPACE_HPP_
+#define DIJKSTRA_WORKSPACE_HPP_
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+
+// Everything a Dijkstra search needs besides the graph: best distances,
+// parents, settled marks and the index priority queue.  The arrays are
+// sized for the graph once and then reused from query to query.
+//
+// Instead of clearing the arrays between queries each vertex carries the
+// number (epoch) of the query that last wrote it; entries from older
+// queries count as unreached.  Together with the list of vertices touched
+// by the current query this makes reset() cost O(touched) rather than O(N),
+// which matters for point queries that only see a small part of a large
+// graph.
+//
+// The queue and touched() keep their capacity across reset(), so once a
+// workspace has seen its largest query, searches in it allocate nothing.
+//
+// A workspace holds the state of one search, so each thread needs its own.
+template <typename T>
+class DijkstraWorkspace {
+ private:
+  std::vector<T> bestDistanceTo {};
+  std::vector<int> prev {};
+  // reachedEpoch.at(v) == epoch if v has a distance in the current query
+  std::vector<unsigned> reachedEpoch {};
+  // settledEpoch.at(v) == epoch once v's neighbours have been explored
+  std::vector<unsigned> settledEpoch {};
+  std::vector<int> touched_ {};
+  IndexPriorityQueue<T> queue_;
+  unsigned epoch = 1;
+
+ public:
+  // workspace for graphs with N vertices
+  explicit DijkstraWorkspace(int N);
+
+  // forget the current query, in time proportional to touched().size()
+  void reset();
+
+  // number of vertices this workspace was made for
+  int size() const;
+
+  // has v been given a distance in the current query?
+  bool reached(int v) const;
+
+  // is v's distance final (v has been taken out of the queue)?
+  bool settled(int v) const;
+
+  // best distance to v found so far, infinity<T>() if v is not reached
+  const T& distance(int v) const;
+
+  // vertex before v on the best path found so far, -1 for the source
+  // and for vertices not reached
+  int parent(int v) const;
+
+  // vertices reached by the current query, in the order first reached
+  const std::vector<int>& touched() const;
+
+  // vertices on the best path found to v, starting with the source
+  // empty if v is not reached
+  std::vector<int> pathTo(int v) const;
+
+  // Building blocks for search functions.
+  // record distance to v via parent and note v as touched
+  void reach(int v, const T& distance, int parent);
+  // the same, moving the distance in
+  void reach(int v, T&& distance, int parent);
+
+  // mark v as settled
+  void settle(int v);
+
+  // the queue, empty between queries
+  IndexPriorityQueue<T>& queue();
+};
+
+template <typename T>
+DijkstraWorkspace<T>::DijkstraWorkspace(int N)
+    : bestDistanceTo(N), prev(N, -1), reachedEpoch(N), settledEpoch(N),
+      queue_(N) {}
+
+template <typename T>
+void DijkstraWorkspace<T>::reset() {
+  // a search that stopped early can leave vertices in the queue
+  queue_.clear();
+  touched_.clear();
+  ++epoch;
+  if (epoch == 0) {
+    // after 2^32 queries the epochs wrap around; start afresh
+    std::fill(reachedEpoch.begin(), reachedEpoch.end(), 0);
+    std::fill(settledEpoch.begin(), settledEpoch.end(), 0);
+    epoch = 1;
+  }
+}
+
+template <typename T>
+int DijkstraWorkspace<T>::size() const {
+  return static_cast<int>(prev.size());
+}
+
+template <typename T>
+bool DijkstraWorkspace<T>::reached(int v) const {
+  return reachedEpoch.at(v) == epoch;
+}
+
+template <typename T>
+bool DijkstraWorkspace<T>::settled(int v) const {
+  return settledEpoch.at(v) == epoch;
+}
+
+template <typename T>
+const T& DijkstraWorkspace<T>::distance(int v) const {
+  static const T unreached {infinity<T>()};
+  return reached(v) ? bestDistanceTo.at(v) : unreached;
+}
+
+template <typename T>
+int DijkstraWorkspace<T>::parent(int v) const {
+  return reached(v) ? prev.at(v) : -1;
+}
+
+template <typename T>
+const std::vector<int>& DijkstraWorkspace<T>::touched() const {
+  return touched_;
+}
+
+template <typename T>
+std::vector<int> DijkstraWorkspace<T>::pathTo(int v) const {
+  std::vector<int> path {};
+  if (!reached(v)) {
+    return path;
+  }
+  for (int current = v; current != -1; current = prev.at(current)) {
+    path.push_back(current);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+template <typename T>
+void DijkstraWorkspace<T>::reach(int v, const T& distance, int parent) {
+  if (!reached(v)) {
+    reachedEpoch.at(v) = epoch;
+    touched_.push_back(v);
+  }
+  bestDistanceTo.at(v) = distance;
+  prev.at(v) = parent;
+}
+
+template <typename T>
+void DijkstraWorkspace<T>::reach(int v, T&& distance, int parent) {
+  if (!reached(v)) {
+    reachedEpoch.at(v) = epoch;
+    touched_.push_back(v);
+  }
+  bestDistanceTo.at(v) = std::move(distance);
+  prev.at(v) = parent;
+}
+
+template <typename T>
+void DijkstraWorkspace<T>::settle(int v) {
+  settledEpoch.at(v) = epoch;
+}
+
+template <typename T>
+IndexPriorityQueue<T>& DijkstraWorkspace<T>::queue() {
+  return queue_;
+}
+
+// Dijkstra with an index priority queue, like singleSourceIndex, but all
+// state lives in workspace and nothing is allocated once the workspace has
+// warmed up.  The workspace is reset first, and afterwards holds the
+// distances and parents of this search.  This is the one search loop the
+// point, bounded, k nearest and matrix queries share; they differ only in
+// when they stop:
+//   - stopBefore(dist) is asked about the next vertex to be settled, at
+//     distance dist, and ends the search leaving it unsettled, as for a
+//     radius
+//   - onSettle(v, dist) is called once v is settled, and ends the search
+//     if it returns true, as for a target.
+// Throws std::out_of_range if source is not a vertex.
+template <typename T, template <typename> class GraphType,
+          typename StopBefore, typename OnSettle>
+void workspaceSearch(const GraphType<T>& G, int source,
+                     DijkstraWorkspace<T>& workspace,
+                     const StopBefore& stopBefore, const OnSettle& onSettle) {
+  if (source < 0 or source >= G.size()) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  workspace.reset();
+  IndexPriorityQueue<T>& queue = workspace.queue();
+  workspace.reach(source, T {}, -1);
+  queue.push(T {}, source);
+  while (!queue.empty()) {
+    int current = queue.topIndex();
+    // the queue holds the same distance as the workspace
+    const T& dist = workspace.distance(current);
+    if (stopBefore(dist)) {
+      break;
+    }
+    queue.pop();
+    workspace.settle(current);
+    if (onSettle(current, dist)) {
+      break;
+    }
+    // relax all outgoing edges of current
+    for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
+      if (workspace.settled(neighbour)) {
+        continue;
+      }
+      T distanceViaCurrent = dist + weight;
+      if (workspace.distance(neighbour) > distanceViaCurrent) {
+        workspace.reach(neighbour, std::move(distanceViaCurrent), current);
+        queue.changeKey(workspace.distance(neighbour), neighbour);
+      }
+    }
+  }
+}
+
+// stopBefore for searches without a radius
+struct NeverStop {
+  template <typename T>
+  bool operator()(const T&) const {
+    return false;
+  }
+};
+
+// If target is a vertex the search stops as soon as target is settled;
+// returns whether target was reached (always true when there is no target).
+template <typename T, template <typename> class GraphType>
+bool singleSourceSearch(const GraphType<T>& G, int source,
+                        DijkstraWorkspace<T>& workspace, int target = -1) {
+  workspaceSearch(G, source, workspace, NeverStop {},
+                  [target](int v, const T&) { return v == target; });
+  return target == -1 or workspace.settled(target);
+}
+
+#endif      // DIJKSTRA_WORKSPACE_HPP_
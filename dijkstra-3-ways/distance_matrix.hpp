@@ -0,0 +1,333 @@
+#ifndef DISTANCE_MATRIX_HPP_
+#define DISTANCE_MATRIX_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "graph.hpp"
+#include "graph_binary.hpp"
+#include "dijkstra_workspace.hpp"
+#include "thread_pool.hpp"
+
+// Many-to-many distances: entry (i, j) of the matrix is the distance from
+// sources[i] to targets[j], infinity<T>() if there is no path.  Each row is
+// one Dijkstra search that stops as soon as every target is settled, so
+// with targets close to the sources only a small part of the graph is
+// searched.  Rows are handed out to the threads of a ThreadPool one at a
+// time, and each thread reuses one DijkstraWorkspace for all its rows.
+template <typename T>
+class DistanceMatrix {
+ private:
+  int rows_ = 0;
+  int columns_ = 0;
+  // row-major, entry (i, j) at entries[i * columns_ + j]
+  std::vector<T> entries {};
+
+ public:
+  // numRows x numColumns matrix of infinity<T>()
+  DistanceMatrix(int numRows, int numColumns);
+
+  // load a matrix written by save() or writeDistanceMatrix(), throws
+  // std::runtime_error if the file does not hold one of this weight type
+  explicit DistanceMatrix(const std::string& filename);
+
+  void save(const std::string& filename) const;
+
+  int numRows() const;
+  int numColumns() const;
+
+  const T& at(int row, int column) const;
+  T& at(int row, int column);
+
+  // numColumns() entries of one row
+  const T* row(int row) const;
+  T* row(int row);
+
+  // all entries, row after row
+  const std::vector<T>& data() const;
+};
+
+// header of a saved distance matrix, laid out like BinaryGraphHeader
+struct DistanceMatrixHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t weightSize;
+  std::uint32_t weightKind;
+  std::uint32_t reserved;      // written as zero
+  std::uint64_t numRows;
+  std::uint64_t numColumns;
+  std::uint64_t checksum;
+  std::uint64_t unused[2];     // written as zero, pads the header to 64 bytes
+};
+
+static_assert(sizeof(DistanceMatrixHeader) == 64);
+
+inline constexpr char distanceMatrixMagic[8] {'I', 'P', 'Q', 'D', 'M', 'A', 'T', 'X'};
+inline constexpr std::uint32_t distanceMatrixVersion = 1;
+
+namespace distance_matrix_detail {
+
+// checks the vertices and marks the targets, returns the number of
+// different targets
+template <typename T, template <typename> class GraphType>
+int markTargets(const GraphType<T>& G, const std::vector<int>& sources,
+                const std::vector<int>& targets, std::vector<char>& isTarget) {
+  int N = G.size();
+  for (int source : sources) {
+    if (source < 0 or source >= N) {
+      throw std::out_of_range("invalid vertex number");
+    }
+  }
+  isTarget.assign(N, 0);
+  int distinctTargets = 0;
+  for (int target : targets) {
+    if (target < 0 or target >= N) {
+      throw std::out_of_range("invalid vertex number");
+    }
+    if (!isTarget.at(target)) {
+      isTarget.at(target) = 1;
+      ++distinctTargets;
+    }
+  }
+  return distinctTargets;
+}
+
+// Dijkstra from source until the distinctTargets marked vertices are
+// settled, then the distances to targets into row
+template <typename T, template <typename> class GraphType>
+void fillRow(const GraphType<T>& G, int source, const std::vector<int>& targets,
+             const std::vector<char>& isTarget, int distinctTargets,
+             DijkstraWorkspace<T>& workspace, T* row) {
+  if (distinctTargets == 0) {
+    return;        // no columns to fill
+  }
+  int targetsLeft = distinctTargets;
+  workspaceSearch(G, source, workspace, NeverStop {},
+                  [&](int current, const T&) {
+                    return isTarget[current] and --targetsLeft == 0;
+                  });
+  for (std::size_t column = 0; column < targets.size(); ++column) {
+    int target = targets[column];
+    row[column] = workspace.settled(target) ? workspace.distance(target)
+                                            : infinity<T>();
+  }
+}
+
+// rows firstRow, ..., lastRow - 1 into out, which starts with firstRow
+template <typename T, template <typename> class GraphType>
+void fillRows(const GraphType<T>& G, const std::vector<int>& sources,
+              int firstRow, int lastRow, const std::vector<int>& targets,
+              const std::vector<char>& isTarget, int distinctTargets,
+              std::vector<DijkstraWorkspace<T> >& workspaces, ThreadPool& pool,
+              T* out) {
+  std::atomic<int> nextRow {firstRow};
+  std::size_t columns = targets.size();
+  pool.run([&](int thread) {
+    for (int i = nextRow++; i < lastRow; i = nextRow++) {
+      fillRow(G, sources[i], targets, isTarget, distinctTargets,
+              workspaces.at(thread), out + (i - firstRow) * columns);
+    }
+  });
+}
+
+}  // namespace distance_matrix_detail
+
+// distances from every source to every target, computed on numThreads
+// threads (see effectiveThreads)
+template <typename T, template <typename> class GraphType>
+DistanceMatrix<T> distanceMatrix(const GraphType<T>& G,
+                                 const std::vector<int>& sources,
+                                 const std::vector<int>& targets,
+                                 int numThreads = defaultThreadCount()) {
+  using namespace distance_matrix_detail;
+  std::vector<char> isTarget {};
+  int distinctTargets = markTargets(G, sources, targets, isTarget);
+  int numRows = static_cast<int>(sources.size());
+  DistanceMatrix<T> matrix {numRows, static_cast<int>(targets.size())};
+  numThreads = std::min(effectiveThreads<T>(numThreads), std::max(1, numRows));
+  ThreadPool pool {numThreads};
+  std::vector<DijkstraWorkspace<T> > workspaces(numThreads,
+                                                DijkstraWorkspace<T>(G.size()));
+  fillRows(G, sources, 0, numRows, targets, isTarget, distinctTargets,
+           workspaces, pool, matrix.row(0));
+  return matrix;
+}
+
+// Like distanceMatrix, but the rows are written to filename as they are
+// computed, rowsPerBlock at a time, so the whole matrix is never held in
+// memory.  The file is in the format of DistanceMatrix<T>::save()
+template <typename T, template <typename> class GraphType>
+void writeDistanceMatrix(const GraphType<T>& G, const std::vector<int>& sources,
+                         const std::vector<int>& targets,
+                         const std::string& outputFile,
+                         int numThreads = defaultThreadCount(),
+                         int rowsPerBlock = 256) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "saved distance matrices need a trivially copyable weight type");
+  using namespace distance_matrix_detail;
+  if (rowsPerBlock < 1) {
+    throw std::invalid_argument("rowsPerBlock must be positive");
+  }
+  std::vector<char> isTarget {};
+  int distinctTargets = markTargets(G, sources, targets, isTarget);
+  int numRows = static_cast<int>(sources.size());
+  std::size_t columns = targets.size();
+  numThreads = std::max(1, std::min(numThreads, numRows));
+  ThreadPool pool {numThreads};
+  std::vector<DijkstraWorkspace<T> > workspaces(numThreads,
+                                                DijkstraWorkspace<T>(G.size()));
+
+  std::ofstream outfile {outputFile, std::ios::binary | std::ios::trunc};
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be opened for writing");
+  }
+  DistanceMatrixHeader header {};
+  std::memcpy(header.magic, distanceMatrixMagic, sizeof(header.magic));
+  header.version = distanceMatrixVersion;
+  header.weightSize = sizeof(T);
+  header.weightKind = binaryWeightKind<T>();
+  header.numRows = numRows;
+  header.numColumns = columns;
+  // written again with the checksum once all rows are out
+  outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  std::uint64_t hash = fnv1a(nullptr, 0);
+  std::vector<T> block(static_cast<std::size_t>(std::min(rowsPerBlock, numRows))
+                       * columns);
+  for (int firstRow = 0; firstRow < numRows; firstRow += rowsPerBlock) {
+    int lastRow = std::min(numRows, firstRow + rowsPerBlock);
+    fillRows(G, sources, firstRow, lastRow, targets, isTarget, distinctTargets,
+             workspaces, pool, block.data());
+    std::size_t length = sizeof(T) * (lastRow - firstRow) * columns;
+    hash = fnv1a(block.data(), length, hash);
+    outfile.write(reinterpret_cast<const char*>(block.data()), length);
+  }
+  header.checksum = hash;
+  outfile.seekp(0);
+  outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be written");
+  }
+}
+
+template <typename T>
+DistanceMatrix<T>::DistanceMatrix(int numRows, int numColumns)
+    : rows_ {numRows}, columns_ {numColumns} {
+  if (numRows < 0 or numColumns < 0) {
+    throw std::invalid_argument("matrix dimensions must not be negative");
+  }
+  entries.assign(static_cast<std::size_t>(numRows) * numColumns, infinity<T>());
+}
+
+template <typename T>
+int DistanceMatrix<T>::numRows() const {
+  return rows_;
+}
+
+template <typename T>
+int DistanceMatrix<T>::numColumns() const {
+  return columns_;
+}
+
+template <typename T>
+const T& DistanceMatrix<T>::at(int row, int column) const {
+  if (row < 0 or row >= rows_ or column < 0 or column >= columns_) {
+    throw std::out_of_range("invalid matrix entry");
+  }
+  return entries[static_cast<std::size_t>(row) * columns_ + column];
+}
+
+template <typename T>
+T& DistanceMatrix<T>::at(int row, int column) {
+  if (row < 0 or row >= rows_ or column < 0 or column >= columns_) {
+    throw std::out_of_range("invalid matrix entry");
+  }
+  return entries[static_cast<std::size_t>(row) * columns_ + column];
+}
+
+template <typename T>
+const T* DistanceMatrix<T>::row(int row) const {
+  return entries.data() + static_cast<std::size_t>(row) * columns_;
+}
+
+template <typename T>
+T* DistanceMatrix<T>::row(int row) {
+  return entries.data() + static_cast<std::size_t>(row) * columns_;
+}
+
+template <typename T>
+const std::vector<T>& DistanceMatrix<T>::data() const {
+  return entries;
+}
+
+template <typename T>
+void DistanceMatrix<T>::save(const std::string& outputFile) const {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "saved distance matrices need a trivially copyable weight type");
+  DistanceMatrixHeader header {};
+  std::memcpy(header.magic, distanceMatrixMagic, sizeof(header.magic));
+  header.version = distanceMatrixVersion;
+  header.weightSize = sizeof(T);
+  header.weightKind = binaryWeightKind<T>();
+  header.numRows = rows_;
+  header.numColumns = columns_;
+  header.checksum = fnv1a(entries.data(), sizeof(T) * entries.size());
+
+  std::ofstream outfile {outputFile, std::ios::binary | std::ios::trunc};
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be opened for writing");
+  }
+  outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  outfile.write(reinterpret_cast<const char*>(entries.data()),
+                sizeof(T) * entries.size());
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be written");
+  }
+}
+
+template <typename T>
+DistanceMatrix<T>::DistanceMatrix(const std::string& inputFile) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "saved distance matrices need a trivially copyable weight type");
+  std::ifstream infile {inputFile, std::ios::binary};
+  if (!infile) {
+    throw std::runtime_error(inputFile + " could not be opened");
+  }
+  DistanceMatrixHeader header {};
+  infile.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!infile or std::memcmp(header.magic, distanceMatrixMagic,
+                             sizeof(header.magic)) != 0) {
+    throw std::runtime_error(inputFile + " is not a distance matrix");
+  }
+  if (header.version != distanceMatrixVersion) {
+    throw std::runtime_error(inputFile + " has an unsupported distance matrix version");
+  }
+  if (header.weightSize != sizeof(T) or header.weightKind != binaryWeightKind<T>()) {
+    throw std::runtime_error(inputFile + " holds a different weight type");
+  }
+  // refuse sizes that cannot be right before allocating anything
+  infile.seekg(0, std::ios::end);
+  std::uint64_t fileSize = static_cast<std::uint64_t>(infile.tellg());
+  infile.seekg(sizeof(header));
+  std::uint64_t limit = std::numeric_limits<int>::max();
+  if (header.numRows > limit or header.numColumns > limit
+      or (header.numColumns > 0 and header.numRows > fileSize / header.numColumns)
+      or fileSize != sizeof(header) + sizeof(T) * header.numRows * header.numColumns) {
+    throw std::runtime_error(inputFile + " is truncated or corrupt");
+  }
+  rows_ = static_cast<int>(header.numRows);
+  columns_ = static_cast<int>(header.numColumns);
+  entries.resize(header.numRows * header.numColumns);
+  infile.read(reinterpret_cast<char*>(entries.data()), sizeof(T) * entries.size());
+  if (!infile or fnv1a(entries.data(), sizeof(T) * entries.size()) != header.checksum) {
+    throw std::runtime_error(inputFile + " is truncated or corrupt");
+  }
+}
+
+#endif      // DISTANCE_MATRIX_HPP_
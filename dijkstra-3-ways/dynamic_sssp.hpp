@@ -0,0 +1,265 @@
+#ifndef DYNAMIC_SSSP_HPP_
+#define DYNAMIC_SSSP_HPP_
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "shortest_path_tree.hpp"
+
+// One change to an edge: set the weight of from -> to, adding the edge if
+// it is not there, or remove the edge if weight is empty.
+template <typename T>
+struct EdgeUpdate {
+  int from {};
+  int to {};
+  std::optional<T> weight {};
+};
+
+// Shortest paths from one source that are kept up to date while edges
+// change, in the spirit of Ramalingam and Reps.  A batch of updates is
+// applied to the graph and then repaired in two steps:
+//   - an edge of the shortest path tree that got heavier or was removed
+//     invalidates the subtree below it.  Those vertices lose their
+//     distances and are given the best distance through an edge from a
+//     vertex outside the subtree, if there is one
+//   - those vertices, and the heads of edges that got lighter or were
+//     added and now give a shorter path, go into an IndexPriorityQueue,
+//     and Dijkstra runs from there until nothing improves.
+// Vertices away from the changes are not looked at, so a small traffic
+// update costs about as much as the part of the tree it changes rather
+// than a search of the whole graph.
+//
+// The structure changes the graph itself, so that graph and distances stay
+// in step; other changes to the graph while it is in use are not noticed.
+// Weights must not be negative.
+template <typename T>
+class DynamicShortestPaths {
+ private:
+  Graph<T>& G;
+  int source_ = 0;
+  // incoming.at(v) maps u to the weight of u -> v, for repairs, which look
+  // at the edges into a vertex
+  std::vector<std::unordered_map<int, T> > incoming {};
+  std::vector<T> bestDistanceTo {};
+  std::vector<int> prev {};
+  std::vector<T> prevWeight {};
+  IndexPriorityQueue<T> queue;
+  int lastSettled = 0;
+
+ public:
+  // shortest paths from source in G, found with one Dijkstra search.
+  // G must outlive the structure
+  DynamicShortestPaths(Graph<T>& G, int source);
+
+  // apply the updates in order, then repair the paths
+  void update(const std::vector<EdgeUpdate<T> >& updates);
+
+  // single updates
+  void setEdge(int from, int to, const T& weight);
+  void removeEdge(int from, int to);
+
+  int source() const;
+  bool reached(int v) const;
+
+  // infinity<T>() if v is not reached
+  const T& distance(int v) const;
+
+  // -1 for the source and vertices not reached
+  int parent(int v) const;
+
+  // vertices on a shortest path from the source to v, empty if v is not
+  // reached
+  std::vector<int> pathTo(int v) const;
+
+  // copy of the current shortest path tree
+  ShortestPathTree<T> tree() const;
+
+  // number of vertices the last update took out of the queue, a measure of
+  // the work it did
+  int lastRepairSize() const;
+
+ private:
+  // label-correcting Dijkstra from what is in the queue
+  void propagate();
+};
+
+template <typename T>
+DynamicShortestPaths<T>::DynamicShortestPaths(Graph<T>& G, int source)
+    : G {G}, source_ {source}, incoming(G.size()),
+      bestDistanceTo(G.size(), infinity<T>()), prev(G.size(), -1),
+      prevWeight(G.size()), queue(G.size()) {
+  if (source < 0 or source >= G.size()) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  for (int u = 0; u < G.size(); ++u) {
+    for (const auto& [v, weight] : *(G.neighbours(u))) {
+      incoming.at(v).insert({u, weight});
+    }
+  }
+  bestDistanceTo.at(source) = T {};
+  queue.push(T {}, source);
+  propagate();
+}
+
+template <typename T>
+void DynamicShortestPaths<T>::update(const std::vector<EdgeUpdate<T> >& updates) {
+  int N = G.size();
+  for (const EdgeUpdate<T>& change : updates) {
+    if (change.from < 0 or change.from >= N or change.to < 0 or change.to >= N) {
+      throw std::out_of_range("invalid vertex number");
+    }
+    if (change.weight and *change.weight < T {}) {
+      throw std::invalid_argument("weights must not be negative");
+    }
+  }
+  // apply the changes, noting the tree edges that got worse
+  std::vector<int> cutBelow {};
+  for (const auto& [from, to, weight] : updates) {
+    if (prev.at(to) == from and (!weight or prevWeight.at(to) < *weight)) {
+      cutBelow.push_back(to);
+    }
+    G.removeEdge(from, to);
+    incoming.at(to).erase(from);
+    if (weight) {
+      G.addEdge(from, to, *weight);
+      incoming.at(to).insert({from, *weight});
+    }
+  }
+
+  // the subtrees below those edges, found through the parent pointers of
+  // the out-neighbours.  A vertex is marked by making it unreached
+  std::vector<int> affected {};
+  for (int root : cutBelow) {
+    if (prev.at(root) == -1) {
+      continue;        // already in an earlier subtree
+    }
+    std::vector<int> stack {root};
+    prev.at(root) = -1;
+    bestDistanceTo.at(root) = infinity<T>();
+    while (!stack.empty()) {
+      int v = stack.back();
+      stack.pop_back();
+      affected.push_back(v);
+      for (const auto& [child, weight] : *(G.neighbours(v))) {
+        if (prev.at(child) == v) {
+          prev.at(child) = -1;
+          bestDistanceTo.at(child) = infinity<T>();
+          stack.push_back(child);
+        }
+      }
+    }
+  }
+  // best way into each affected vertex from the rest of the tree
+  for (int v : affected) {
+    for (const auto& [from, weight] : incoming.at(v)) {
+      if (bestDistanceTo.at(from) == infinity<T>()) {
+        continue;
+      }
+      T distanceViaFrom = bestDistanceTo.at(from) + weight;
+      if (distanceViaFrom < bestDistanceTo.at(v)) {
+        bestDistanceTo.at(v) = distanceViaFrom;
+        prev.at(v) = from;
+        prevWeight.at(v) = weight;
+      }
+    }
+    if (bestDistanceTo.at(v) != infinity<T>()) {
+      queue.changeKey(bestDistanceTo.at(v), v);
+    }
+  }
+  // edges that now give a shorter path
+  for (const auto& [from, to, weight] : updates) {
+    if (!weight or bestDistanceTo.at(from) == infinity<T>()
+        or !G.isEdge(from, to) or G.getEdgeWeight(from, to) != *weight) {
+      continue;
+    }
+    T distanceViaFrom = bestDistanceTo.at(from) + *weight;
+    if (distanceViaFrom < bestDistanceTo.at(to)) {
+      bestDistanceTo.at(to) = distanceViaFrom;
+      prev.at(to) = from;
+      prevWeight.at(to) = *weight;
+      queue.changeKey(distanceViaFrom, to);
+    }
+  }
+  propagate();
+}
+
+template <typename T>
+void DynamicShortestPaths<T>::propagate() {
+  lastSettled = 0;
+  while (!queue.empty()) {
+    int current = queue.topIndex();
+    queue.pop();
+    ++lastSettled;
+    // the queue holds the same distance as bestDistanceTo
+    const T& dist = bestDistanceTo.at(current);
+    // relax all outgoing edges of current
+    for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
+      T distanceViaCurrent = dist + weight;
+      if (distanceViaCurrent < bestDistanceTo.at(neighbour)) {
+        bestDistanceTo.at(neighbour) = std::move(distanceViaCurrent);
+        prev.at(neighbour) = current;
+        prevWeight.at(neighbour) = weight;
+        queue.changeKey(bestDistanceTo.at(neighbour), neighbour);
+      }
+    }
+  }
+}
+
+template <typename T>
+void DynamicShortestPaths<T>::setEdge(int from, int to, const T& weight) {
+  update({{from, to, weight}});
+}
+
+template <typename T>
+void DynamicShortestPaths<T>::removeEdge(int from, int to) {
+  update({{from, to, std::nullopt}});
+}
+
+template <typename T>
+int DynamicShortestPaths<T>::source() const {
+  return source_;
+}
+
+template <typename T>
+bool DynamicShortestPaths<T>::reached(int v) const {
+  return bestDistanceTo.at(v) != infinity<T>();
+}
+
+template <typename T>
+const T& DynamicShortestPaths<T>::distance(int v) const {
+  return bestDistanceTo.at(v);
+}
+
+template <typename T>
+int DynamicShortestPaths<T>::parent(int v) const {
+  return prev.at(v);
+}
+
+template <typename T>
+std::vector<int> DynamicShortestPaths<T>::pathTo(int v) const {
+  std::vector<int> path {};
+  if (!reached(v)) {
+    return path;
+  }
+  for (int current = v; current != -1; current = prev.at(current)) {
+    path.push_back(current);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+template <typename T>
+ShortestPathTree<T> DynamicShortestPaths<T>::tree() const {
+  return {source_, prev, bestDistanceTo, prevWeight};
+}
+
+template <typename T>
+int DynamicShortestPaths<T>::lastRepairSize() const {
+  return lastSettled;
+}
+
+#endif      // DYNAMIC_SSSP_HPP_
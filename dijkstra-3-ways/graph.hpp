@@ -11,14 +11,24 @@
 #include <set>
 #include <unordered_map>
 #include <limits>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 #include "my_integer.hpp"
+#include "graph_reader.hpp"
 #include "indexPriorityQueue.cpp"
+#include "shortest_path_tree.hpp"
+#include "thread_pool.hpp"
 
 template <typename T>
 class Graph {
  private:
   std::vector<std::unordered_map<int, T> > adjList {};
   int numVertices {};
+  // the graph with every edge turned around, built by the first call to
+  // reverse() and dropped whenever an edge is added or removed
+  mutable std::shared_ptr<const Graph<T> > reversed {};
 
  public:
   // empty graph with N vertices
@@ -43,6 +53,12 @@ class Graph {
   // returns number of vertices in the graph
   int size() const;
 
+  // the graph with an edge j -> i for every edge i -> j, for searching
+  // backwards.  Built on the first call and kept until the graph changes.
+  // The first call is not thread safe, make it before sharing the graph
+  // between threads
+  const Graph<T>& reverse() const;
+
   // alias a const iterator to our adjacency list type to iterator
   using iterator = 
   typename std::vector<std::unordered_map<int, T> >::const_iterator;
@@ -65,23 +81,22 @@ class Graph {
 template <typename T>
 Graph<T>::Graph(int N) : adjList(N), numVertices {N} {}
 
+// the file can be in EWD or DIMACS format, see graph_reader.hpp
 template <typename T>
 Graph<T>::Graph(const std::string& inputFile) {
-  std::ifstream infile {inputFile};
-  if (!infile) {
-    std::cerr << inputFile << " could not be opened\n";
-    return;
-  }
-  // first line has number of vertices
-  infile >> numVertices;
+  EdgeList edges {readEdgeList(inputFile)};
+  numVertices = edges.numVertices;
   adjList.resize(numVertices);
-  int i {};
-  int j {};
-  double weight {};
-  // assume each remaining line is of form
-  // origin dest weight
-  while (infile >> i >> j >> weight) {
-    addEdge(i, j, static_cast<T>(weight));
+  // size each hash map once up front instead of rehashing as it grows
+  std::vector<int> outDegree(numVertices);
+  for (int from : edges.from) {
+    ++outDegree.at(from);
+  }
+  for (int i = 0; i < numVertices; ++i) {
+    adjList[i].reserve(outDegree[i]);
+  }
+  for (int e = 0; e < edges.numEdges(); ++e) {
+    addEdge(edges.from[e], edges.to[e], static_cast<T>(edges.weights[e]));
   }
 }
 
@@ -96,6 +111,7 @@ void Graph<T>::addEdge(int i, int j, T weight) {
     throw std::out_of_range("invalid vertex number");
   }
   adjList[i].insert({j, weight});
+  reversed.reset();
 }
 
 template <typename T>
@@ -103,6 +119,7 @@ void Graph<T>::removeEdge(int i, int j) {
   // check if i and j are valid
   if (i >= 0 && i < numVertices && j >= 0 && j < numVertices) {
     adjList[i].erase(j);
+    reversed.reset();
   }
 }
 
@@ -119,6 +136,20 @@ T Graph<T>::getEdgeWeight(int i, int j) const {
   return adjList.at(i).at(j);
 }
 
+template <typename T>
+const Graph<T>& Graph<T>::reverse() const {
+  if (!reversed) {
+    auto R = std::make_shared<Graph<T> >(numVertices);
+    for (int i = 0; i < numVertices; ++i) {
+      for (const auto& [neighbour, weight] : adjList[i]) {
+        R->adjList[neighbour].insert({i, weight});
+      }
+    }
+    reversed = std::move(R);
+  }
+  return *reversed;
+}
+
 template <typename T>
 std::ostream& operator<<(std::ostream& out, const Graph<T>& G) {
   for (int i = 0; i < G.size(); ++i) {
@@ -133,6 +164,11 @@ std::ostream& operator<<(std::ostream& out, const Graph<T>& G) {
 
 // End of functions from Graph class
 
+// The shortest path functions and checkers below are templated on the graph
+// type as well as the weight type.  They work with any graph offering the
+// read-only interface of Graph<T> (size, neighbours, isEdge, getEdgeWeight),
+// for example the CompactGraph<T> in compact_graph.hpp.
+
 // return a number of type T to stand in for "infinity"
 template <typename T>
 T infinity() {
@@ -146,8 +182,8 @@ T infinity() {
 }
 
 // lazy solution as in Tutorial Week 10
-template <typename T>
-std::vector<T> singleSourceLazyDistance(const Graph<T>& G, int source) {
+template <typename T, template <typename> class GraphType>
+std::vector<T> singleSourceLazyDistance(const GraphType<T>& G, int source) {
   // alias the long name for a minimum priority queue holding
   // objects of type DistAndVertex
   using DistAndVertex = std::pair<T, int>; //(ME)stores distance to a vertex ALONG WITH the vertex itself. (distance is T, int is vertex it reaches)
@@ -164,7 +200,7 @@ std::vector<T> singleSourceLazyDistance(const Graph<T>& G, int source) {
   // the bestDistanceTo for a vertex in visited is the true distance.
   std::vector<bool> visited(N);
   while (!queue.empty()) {
-    auto [dist, current] = queue.top(); //dist is the distance to vertex //current is the current vertex the distance to is being calculated of
+    int current = queue.top().second; //current is the vertex the distance to is being calculated of, bestDistanceTo.at(current) is that distance
     queue.pop(); //pops it out means it's the lowest in the shortest path tree.
     // as we use a lazy version of Dijkstra a vertex can appear multiple
     // times in the queue.  If we have already visited the vertex we
@@ -177,31 +213,35 @@ std::vector<T> singleSourceLazyDistance(const Graph<T>& G, int source) {
     for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
       T distanceViaCurrent = bestDistanceTo.at(current) + weight;
       if (bestDistanceTo.at(neighbour) > distanceViaCurrent) {
-        bestDistanceTo.at(neighbour) = distanceViaCurrent;
+        bestDistanceTo.at(neighbour) = std::move(distanceViaCurrent);
         // lazy dijkstra: nextPoint could already be in the queue
         // we don't update it with better distance just found.
-        queue.push({distanceViaCurrent, neighbour});
+        queue.push({bestDistanceTo.at(neighbour), neighbour});
       }
     } //graph, that is the shortest path, and im doing that by adding the edges to the shortest path tree getting the shortest path into the shortest path tree
   }
   return bestDistanceTo;
 }
 
-// Solution using an index priority queue here
-template <typename T>
-Graph<T> singleSourceIndex(const Graph<T>& G, int source) {
+// Dijkstra with any queue offering the IndexPriorityQueue interface
+// (push, pop, topIndex, changeKey, empty), for example a d-ary
+// IndexPriorityQueue<T, 4>.  Returns the parent array of the search
+// instead of building a graph
+template <typename Queue, typename T, template <typename> class GraphType>
+ShortestPathTree<T> singleSourceIndexTreeWith(const GraphType<T>& G, int source) {
   int N = G.size();
-  IndexPriorityQueue<T> queue{N};
+  Queue queue{N};
   queue.push(T{}, source); 
   std::vector<T> bestDistanceTo(N, infinity<T>());
   std::vector<int> prev(N, -1);
+  // weight of the edge prev -> vertex, so the tree needs no lookups in G
+  std::vector<T> prevWeight(N);
   bestDistanceTo.at(source) = T {};
   // being in visited means we have already explored a vertex's neighbours
   // the bestDistanceTo for a vertex in visited is the true distance.
   std::vector<bool> visited(N);
-  Graph<T> shortestPath{N};
   while (!queue.empty()) {
-    auto [dist, current] = queue.top(); //dist is the distance to vertex //current is the current vertex the distance to is being calculated of
+    int current = queue.topIndex(); //current is the vertex the distance to is being calculated of, bestDistanceTo.at(current) is that distance
   
     queue.pop(); //pops it out means it's the lowest in the shortest path tree.
     if (visited.at(current)) {
@@ -212,40 +252,118 @@ Graph<T> singleSourceIndex(const Graph<T>& G, int source) {
     for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
       T distanceViaCurrent = bestDistanceTo.at(current) + weight;
       if (bestDistanceTo.at(neighbour) > distanceViaCurrent) {// priorities.at(priorityQueue.at(neighbour))
-        bestDistanceTo.at(neighbour) = distanceViaCurrent;
+        bestDistanceTo.at(neighbour) = std::move(distanceViaCurrent);
         prev.at(neighbour) = current; // previous element pointed to neighbour by current 
-        queue.changeKey(distanceViaCurrent, neighbour); //updatest he priority queue to visit the next best priority
+        prevWeight.at(neighbour) = weight;
+        queue.changeKey(bestDistanceTo.at(neighbour), neighbour); //updatest he priority queue to visit the next best priority
       }
     } 
   }
-  for (auto i = 0; i < N; i++){
-    if(prev.at(i) != -1) {
-    shortestPath.addEdge(prev.at(i), i, G.getEdgeWeight(prev.at(i), i));
+  return {source, std::move(prev), std::move(bestDistanceTo),
+          std::move(prevWeight)};
+}
+
+template <typename Queue, typename T, template <typename> class GraphType>
+Graph<T> singleSourceIndexWith(const GraphType<T>& G, int source) {
+  return singleSourceIndexTreeWith<Queue>(G, source).toGraph();
+}
+
+template <typename T, template <typename> class GraphType>
+ShortestPathTree<T> singleSourceIndexTree(const GraphType<T>& G, int source) {
+  return singleSourceIndexTreeWith<IndexPriorityQueue<T> >(G, source);
+}
+
+// Solution using an index priority queue here
+template <typename T, template <typename> class GraphType>
+Graph<T> singleSourceIndex(const GraphType<T>& G, int source) {
+  return singleSourceIndexWith<IndexPriorityQueue<T> >(G, source);
+}
+
+// a source of a multi source search, which starts offset away from it
+template <typename T>
+struct SourceOffset {
+  int vertex {};
+  T offset {};
+};
+
+// Dijkstra from several sources at once, as if from an extra vertex with
+// an edge of weight offset to each of them: every vertex gets the smallest
+// offset plus distance over all sources, and its parents lead back to the
+// source that gives it.  The sources go into the queue together through
+// IndexPriorityQueue::assign, which heapifies them in linear time.  A
+// source given twice keeps its smaller offset; a source reached for less
+// than its offset from another source gets a parent like any vertex.
+// Throws std::out_of_range for a source that is not a vertex.
+template <typename T, template <typename> class GraphType>
+ShortestPathTree<T> multiSourceIndexTree(const GraphType<T>& G,
+                                         const std::vector<SourceOffset<T> >& sources) {
+  int N = G.size();
+  std::vector<T> bestDistanceTo(N, infinity<T>());
+  std::vector<int> prev(N, -1);
+  std::vector<T> prevWeight(N);
+  std::vector<int> sourceVertices {};
+  for (const auto& [vertex, offset] : sources) {
+    if (vertex < 0 or vertex >= N) {
+      throw std::out_of_range("invalid vertex number");
+    }
+    if (bestDistanceTo.at(vertex) == infinity<T>()) {
+      sourceVertices.push_back(vertex);
+    }
+    if (offset < bestDistanceTo.at(vertex)) {
+      bestDistanceTo.at(vertex) = offset;
+    }
+  }
+  std::vector<std::pair<T, int> > seeds {};
+  seeds.reserve(sourceVertices.size());
+  for (int vertex : sourceVertices) {
+    seeds.push_back({bestDistanceTo.at(vertex), vertex});
+  }
+  IndexPriorityQueue<T> queue {N, seeds};
+  while (!queue.empty()) {
+    int current = queue.topIndex();
+    queue.pop();
+    // the queue holds the same distance as bestDistanceTo
+    const T& dist = bestDistanceTo.at(current);
+    // relax all outgoing edges of current; a vertex leaves the queue once,
+    // and distances of vertices that left it cannot improve
+    for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
+      T distanceViaCurrent = dist + weight;
+      if (bestDistanceTo.at(neighbour) > distanceViaCurrent) {
+        bestDistanceTo.at(neighbour) = std::move(distanceViaCurrent);
+        prev.at(neighbour) = current;
+        prevWeight.at(neighbour) = weight;
+        queue.changeKey(bestDistanceTo.at(neighbour), neighbour);
+      }
     }
   }
-  return shortestPath;
+  return {std::move(sourceVertices), std::move(prev), std::move(bestDistanceTo),
+          std::move(prevWeight)};
 }
 
-// Implement your lazy solution using std::priority_queue here
-template <typename T>
-Graph<T> singleSourceLazy(const Graph<T>& G, int source) {
-  using DistAndVertex = std::pair<T, int>;
-  using minPQ = std::priority_queue<DistAndVertex,
-                                  std::vector<DistAndVertex>,
-                                  std::greater<DistAndVertex> >; //minimum priorityqueue
-  minPQ queue {};
+template <typename T, template <typename> class GraphType>
+Graph<T> multiSourceIndex(const GraphType<T>& G,
+                          const std::vector<SourceOffset<T> >& sources) {
+  return multiSourceIndexTree(G, sources).toGraph();
+}
+
+// Lazy Dijkstra with any queue of (distance, vertex) pairs offering the
+// std::priority_queue interface (push, pop, top, empty), for example the
+// RadixHeap in radix_heap.hpp.  Returns the parent array of the search
+template <typename Queue, typename T, template <typename> class GraphType>
+ShortestPathTree<T> singleSourceLazyTreeWith(const GraphType<T>& G, int source) {
+  Queue queue {};
   queue.push({T {}, source});
   // record best distance to vertex found so far
   int N = G.size();
   std::vector<T> bestDistanceTo(N, infinity<T>());
   std::vector<int> prev(N, -1);
+  std::vector<T> prevWeight(N);
   bestDistanceTo.at(source) = T {};
   // being in visited means we have already explored a vertex's neighbours
   // the bestDistanceTo for a vertex in visited is the true distance.
   std::vector<bool> visited(N);
-  Graph<T> shortestPath{N};
   while (!queue.empty()) {
-    auto [dist, current] = queue.top(); //dist is the distance to vertex //current is the current vertex the distance to is being calculated of
+    int current = queue.top().second; //current is the vertex the distance to is being calculated of, bestDistanceTo.at(current) is that distance
     queue.pop(); //pops it out means it's the lowest in the shortest path tree.
     if (visited.at(current)) {
       continue;
@@ -255,40 +373,284 @@ Graph<T> singleSourceLazy(const Graph<T>& G, int source) {
     for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
       T distanceViaCurrent = bestDistanceTo.at(current) + weight;
       if (bestDistanceTo.at(neighbour) > distanceViaCurrent) {
-        bestDistanceTo.at(neighbour) = distanceViaCurrent;
+        bestDistanceTo.at(neighbour) = std::move(distanceViaCurrent);
         prev.at(neighbour) = current; // previous element pointed to neighbour by current 
+        prevWeight.at(neighbour) = weight;
         // lazy dijkstra: nextPoint could already be in the queue
         // we don't update it with better distance just found.
-        queue.push({distanceViaCurrent, neighbour});
+        queue.push({bestDistanceTo.at(neighbour), neighbour});
       }
-      // shortestPath.addEdge(current, neighbour, distanceViaCurrent);
     } //graph, that is the shortest path, and im doing that by adding the edges to the shortest path tree getting the shortest path into the shortest path tree
   }
+  return {source, std::move(prev), std::move(bestDistanceTo),
+          std::move(prevWeight)};
+}
 
-  for (auto i = 0; i < N; i++){
-    if(prev.at(i) != -1) {//&& i != 0) { //checks for source and isolated vertex
-      shortestPath.addEdge(prev.at(i), i, G.getEdgeWeight(prev.at(i), i));
-    }
-  }
-  return shortestPath;
+template <typename Queue, typename T, template <typename> class GraphType>
+Graph<T> singleSourceLazyWith(const GraphType<T>& G, int source) {
+  return singleSourceLazyTreeWith<Queue>(G, source).toGraph();
+}
+
+template <typename T, template <typename> class GraphType>
+ShortestPathTree<T> singleSourceLazyTree(const GraphType<T>& G, int source) {
+  using DistAndVertex = std::pair<T, int>;
+  using minPQ = std::priority_queue<DistAndVertex,
+                                  std::vector<DistAndVertex>,
+                                  std::greater<DistAndVertex> >; //minimum priorityqueue
+  return singleSourceLazyTreeWith<minPQ>(G, source);
+}
+
+// Implement your lazy solution using std::priority_queue here
+template <typename T, template <typename> class GraphType>
+Graph<T> singleSourceLazy(const GraphType<T>& G, int source) {
+  return singleSourceLazyTree(G, source).toGraph();
 }
 
 // Implement your solution using std::set here
-template <typename T>
-Graph<T> singleSourceSet(const Graph<T>& G, int source) {
+template <typename T, template <typename> class GraphType>
+Graph<T> singleSourceSet(const GraphType<T>& G, int source) {
   return Graph<T> {G.size()};
 }
 
+// a weight or distance as a double, for working out statistics
+template <typename T>
+double asDouble(const T& value) {
+  if constexpr (std::is_same_v<T, MyInteger>) {
+    return value.value;
+  } else {
+    return static_cast<double>(value);
+  }
+}
+
+// a - b, which MyInteger has no operator for
+template <typename T>
+T distanceGap(const T& a, const T& b) {
+  if constexpr (std::is_same_v<T, MyInteger>) {
+    return MyInteger {a.value - b.value};
+  } else {
+    return a - b;
+  }
+}
+
+// number of the delta-stepping bucket a distance falls in
+template <typename T>
+long long deltaBucket(const T& distance, const T& delta) {
+  if constexpr (std::is_same_v<T, MyInteger>) {
+    return distance.value / delta.value;
+  } else {
+    return static_cast<long long>(distance / delta);
+  }
+}
+
+// bucket width used when none is given: the average edge weight, so a
+// bucket spans about one edge.  At least 1 for integer weights.
+template <typename T, template <typename> class GraphType>
+T defaultDelta(const GraphType<T>& G) {
+  double total = 0;
+  long long count = 0;
+  for (int v = 0; v < G.size(); ++v) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(v))) {
+      total += asDouble(weight);
+      ++count;
+    }
+  }
+  double average = count > 0 ? total / count : 1.0;
+  if constexpr (std::is_same_v<T, MyInteger>) {
+    return MyInteger {std::max(1, static_cast<int>(average))};
+  } else if constexpr (std::is_integral_v<T>) {
+    return std::max(T {1}, static_cast<T>(average));
+  } else {
+    return average > 0 ? static_cast<T>(average) : T {1};
+  }
+}
+
+// Delta-stepping (Meyer and Sanders), a parallel label-correcting version
+// of Dijkstra for non-negative weights.  Vertices are kept in buckets of
+// width delta by tentative distance and the lowest non-empty bucket is
+// worked on as a whole:
+//   - light edges (weight <= delta) of the vertices in the bucket are
+//     relaxed, which can put vertices back into the same bucket, so this
+//     is repeated in phases until the bucket stays empty
+//   - then the heavy edges of every vertex removed from the bucket are
+//     relaxed once; they can only reach later buckets.
+// Each phase runs on a ThreadPool in two rounds.  First every thread
+// relaxes the edges of its part of the frontier, reading distances only and
+// writing relaxation requests.  Then every thread applies the requests for
+// the vertices it owns.  Vertices are owned in blocks of 64 so threads do
+// not write to the same cache lines, and as only the owner writes a vertex's
+// distance, parent and bucket entries no locks or atomics are needed.
+//
+// A small delta does little extra work but has many phases, a large delta
+// gives fewer phases with more vertices each but relaxes edges more often.
+// The number of threads goes through effectiveThreads.
+template <typename T, template <typename> class GraphType>
+ShortestPathTree<T> singleSourceDeltaSteppingTree(const GraphType<T>& G,
+                                                  int source, const T& delta,
+                                                  int numThreads = defaultThreadCount()) {
+  int N = G.size();
+  if (source < 0 or source >= N) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  if (!(T {} < delta)) {
+    throw std::invalid_argument("delta must be positive");
+  }
+  numThreads = effectiveThreads<T>(numThreads);
+  auto owner = [numThreads](int v) { return (v / 64) % numThreads; };
+
+  struct Request {
+    int vertex;
+    int parent;
+    T distance;
+    T weight;
+  };
+  std::vector<T> bestDistanceTo(N, infinity<T>());
+  std::vector<int> prev(N, -1);
+  std::vector<T> prevWeight(N);
+  // buckets.at(t).at(b) holds the vertices of thread t whose tentative
+  // distance fell in bucket b when they were added.  Entries are not removed
+  // when a distance improves, stale ones are skipped instead
+  std::vector<std::vector<std::vector<int> > > buckets(numThreads);
+  // vertices of each thread whose light edges are relaxed in this phase
+  std::vector<std::vector<int> > frontier(numThreads);
+  // vertices of each thread taken out of the current bucket, whose heavy
+  // edges are relaxed once the bucket is finished
+  std::vector<std::vector<int> > removed(numThreads);
+  // requests.at(from).at(to) are relaxations found by thread from for
+  // vertices owned by thread to
+  std::vector<std::vector<std::vector<Request> > > requests(
+      numThreads, std::vector<std::vector<Request> >(numThreads));
+  // the phase in which a vertex last joined the frontier, and the bucket
+  // in which it was last removed, so neither list holds it twice
+  std::vector<long long> frontierPhase(N, -1);
+  std::vector<long long> removedBucket(N, -1);
+
+  bestDistanceTo.at(source) = T {};
+  buckets.at(owner(source)).resize(1);
+  buckets.at(owner(source)).at(0).push_back(source);
+
+  // round 1: thread t relaxes the light or heavy edges leaving vertices
+  auto relaxEdges = [&](int t, const std::vector<int>& vertices, bool light) {
+    for (std::vector<Request>& forOwner : requests[t]) {
+      forOwner.clear();
+    }
+    for (int current : vertices) {
+      const T& distanceToCurrent = bestDistanceTo[current];
+      for (const auto& [neighbour, weight] : *(G.neighbours(current))) {
+        if ((weight <= delta) != light) {
+          continue;
+        }
+        T distanceViaCurrent = distanceToCurrent + weight;
+        if (distanceViaCurrent < bestDistanceTo[neighbour]) {
+          requests[t][owner(neighbour)].push_back(
+              {neighbour, current, distanceViaCurrent, weight});
+        }
+      }
+    }
+  };
+  // round 2: thread t applies the requests for its own vertices
+  auto applyRequests = [&](int t) {
+    std::vector<std::vector<int> >& myBuckets = buckets[t];
+    for (int from = 0; from < numThreads; ++from) {
+      for (const Request& request : requests[from][t]) {
+        if (request.distance < bestDistanceTo[request.vertex]) {
+          bestDistanceTo[request.vertex] = request.distance;
+          prev[request.vertex] = request.parent;
+          prevWeight[request.vertex] = request.weight;
+          std::size_t b = deltaBucket(request.distance, delta);
+          if (b >= myBuckets.size()) {
+            myBuckets.resize(b + 1);
+          }
+          myBuckets[b].push_back(request.vertex);
+        }
+      }
+    }
+  };
+  // thread t moves the live entries of bucket b into its frontier
+  auto takeBucket = [&](int t, long long b, long long phase) {
+    frontier[t].clear();
+    if (static_cast<std::size_t>(b) >= buckets[t].size()) {
+      return;
+    }
+    for (int v : buckets[t][b]) {
+      if (frontierPhase[v] == phase
+          or deltaBucket(bestDistanceTo[v], delta) != b) {
+        continue;
+      }
+      frontierPhase[v] = phase;
+      frontier[t].push_back(v);
+      if (removedBucket[v] != b) {
+        removedBucket[v] = b;
+        removed[t].push_back(v);
+      }
+    }
+    buckets[t][b].clear();
+  };
+  auto frontierEmpty = [&]() {
+    return std::all_of(frontier.begin(), frontier.end(),
+                       [](const std::vector<int>& part) { return part.empty(); });
+  };
+  // lowest bucket from b on with any entries, -1 if there is none
+  auto nextBucket = [&](long long b) {
+    long long next = -1;
+    for (const auto& myBuckets : buckets) {
+      for (long long i = b; i < static_cast<long long>(myBuckets.size()); ++i) {
+        if (!myBuckets[i].empty()) {
+          if (next == -1 or i < next) {
+            next = i;
+          }
+          break;
+        }
+      }
+    }
+    return next;
+  };
+
+  ThreadPool pool {numThreads};
+  long long phase = 0;
+  for (long long b = nextBucket(0); b != -1; b = nextBucket(b + 1)) {
+    ++phase;
+    pool.run([&](int t) { takeBucket(t, b, phase); });
+    while (!frontierEmpty()) {
+      pool.run([&](int t) { relaxEdges(t, frontier[t], true); });
+      ++phase;
+      // the entries just added are for vertices of thread t only, so it
+      // can go on to take them without waiting for the others
+      pool.run([&](int t) {
+        applyRequests(t);
+        takeBucket(t, b, phase);
+      });
+    }
+    pool.run([&](int t) { relaxEdges(t, removed[t], false); });
+    pool.run([&](int t) {
+      applyRequests(t);
+      removed[t].clear();
+      // nothing goes into a finished bucket again, so free it
+      if (static_cast<std::size_t>(b) < buckets[t].size()) {
+        std::vector<int> {}.swap(buckets[t][b]);
+      }
+    });
+  }
+  return {source, std::move(prev), std::move(bestDistanceTo),
+          std::move(prevWeight)};
+}
+
+// delta-stepping with the default bucket width and all hardware threads
+template <typename T, template <typename> class GraphType>
+Graph<T> singleSourceDeltaStepping(const GraphType<T>& G, int source) {
+  return singleSourceDeltaSteppingTree(G, source, defaultDelta(G)).toGraph();
+}
+
 // put your "best" solution here
 // this is the one we will use for performance testing
 template <typename T>
 Graph<T> singleSourceShortestPaths(const Graph<T>& G, int source) {
-  return Graph<T> {G.size()}; 
+  return singleSourceDeltaStepping(G, source);
 }
 
 
-template <typename T>
-bool isSubgraph(const Graph<T>& H, const Graph<T>& G) {
+template <typename T, template <typename> class TreeType,
+          template <typename> class GraphType>
+bool isSubgraph(const TreeType<T>& H, const GraphType<T>& G) {
 
   if (H.size() > G.size()) {
     return false;
@@ -313,8 +675,8 @@ bool isSubgraph(const Graph<T>& H, const Graph<T>& G) {
       return true;
 }
 
-template <typename T>
-bool isTreePlusIsolated(const Graph<T>& G, int root) {
+template <typename T, template <typename> class GraphType>
+bool isTreePlusIsolated(const GraphType<T>& G, int root) {
   //BFS. If visited node > 1, cycle exists! return false.
   std::queue<int> graphQueue {}; //storing int number of vertices
   std::vector<bool> visited(G.size());
@@ -344,8 +706,8 @@ bool isTreePlusIsolated(const Graph<T>& G, int root) {
   return true;
 }
 
-template <typename T>
-std::vector<T> pathLengthsFromRoot(const Graph<T>& tree, int root) { 
+template <typename T, template <typename> class GraphType>
+std::vector<T> pathLengthsFromRoot(const GraphType<T>& tree, int root) { 
   std::vector<T> bestDistanceTo(tree.size(), infinity<T>());//makes the bestDistanceTo //size and each elements starting point
   std::queue<int> treeQueue {};
   std::vector<bool> visited(tree.size()); 
@@ -381,8 +743,108 @@ std::vector<T> pathLengthsFromRoot(const Graph<T>& tree, int root) {
 
 
 
+// The checkers below take a ShortestPathTree<T> (shortest_path_tree.hpp)
+// directly, so a search result can be checked without turning it into a
+// Graph<T> first.  Each vertex has at most one parent, so following parents
+// visits every vertex at most once when finished chains are remembered.
+
+// every tree edge parent(v) -> v must be an edge of G with the same weight
+template <typename T, template <typename> class GraphType>
+bool isSubgraph(const ShortestPathTree<T>& tree, const GraphType<T>& G) {
+  if (tree.size() > G.size()) {
+    return false;
+  }
+  for (int v {}; v < tree.size(); v++) {
+    int parent = tree.parent(v);
+    if (parent == -1) {
+      continue;
+    }
+    if (!G.isEdge(parent, v)) {
+      return false;
+    }
+    if (G.getEdgeWeight(parent, v) != tree.parentWeight(v)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// following parents from any vertex with a parent must lead to root
+// without going round a cycle.  Vertices without a parent are isolated.
 template <typename T>
-bool allEdgesRelaxed(const std::vector<T>& bestDistanceTo, const Graph<T>& G, 
+bool isTreePlusIsolated(const ShortestPathTree<T>& tree, int root) {
+  int N = tree.size();
+  if (root != tree.source() or tree.parent(root) != -1) {
+    return false;
+  }
+  // leadsToRoot.at(v) is true once the parent chain of v is known to end at root
+  std::vector<bool> leadsToRoot(N);
+  leadsToRoot.at(root) = true;
+  std::vector<int> chain {};
+  for (int v {}; v < N; v++) {
+    if (tree.parent(v) == -1) {
+      continue;
+    }
+    chain.clear();
+    int current = v;
+    while (current != -1 and !leadsToRoot.at(current)) {
+      // a chain longer than N vertices must go round a cycle
+      if (static_cast<int>(chain.size()) == N) {
+        return false;
+      }
+      chain.push_back(current);
+      current = tree.parent(current);
+      if (current < -1 or current >= N) {
+        return false;
+      }
+    }
+    if (current == -1) {
+      // ended at a vertex other than root
+      return false;
+    }
+    for (int w : chain) {
+      leadsToRoot.at(w) = true;
+    }
+  }
+  return true;
+}
+
+// add up the parent edge weights from each vertex back to root.  Vertices
+// whose parents do not lead to root get infinity<T>()
+template <typename T>
+std::vector<T> pathLengthsFromRoot(const ShortestPathTree<T>& tree, int root) {
+  int N = tree.size();
+  std::vector<T> bestDistanceTo(N, infinity<T>());
+  // 0 not looked at yet, 1 length known, 2 does not lead to root
+  std::vector<char> state(N);
+  bestDistanceTo.at(root) = T {};
+  state.at(root) = 1;
+  std::vector<int> chain {};
+  for (int v {}; v < N; v++) {
+    chain.clear();
+    int current = v;
+    while (current != -1 and state.at(current) == 0
+           and static_cast<int>(chain.size()) < N) {
+      chain.push_back(current);
+      current = tree.parent(current);
+    }
+    bool known = current != -1 and state.at(current) == 1;
+    // walk back down the chain adding one edge at a time
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      if (known) {
+        bestDistanceTo.at(*it) = bestDistanceTo.at(tree.parent(*it))
+                                 + tree.parentWeight(*it);
+        state.at(*it) = 1;
+      } else {
+        state.at(*it) = 2;
+      }
+    }
+  }
+  return bestDistanceTo;
+}
+
+template <typename T, template <typename> class GraphType>
+bool allEdgesRelaxed(const std::vector<T>& bestDistanceTo, const GraphType<T>& G, 
                       int source) {
   
   if (bestDistanceTo.at(source) != T{}){
@@ -0,0 +1,380 @@
+#ifndef GRAPH_BINARY_HPP_
+#define GRAPH_BINARY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "compact_graph.hpp"
+
+// On-disk binary layout of a CSR graph, so a graph can be opened with
+// mmap and used straight away without any parsing or copying.
+//
+//   BinaryGraphHeader                      (64 bytes)
+//   int32 offsets[numVertices + 1]
+//   int32 targets[numEdges]
+//   zero padding up to a multiple of 8 bytes
+//   T     weights[numEdges]
+//
+// All values are stored in the byte order of the machine that wrote the
+// file.  The checksum is a 64-bit FNV-1a hash of everything after the
+// header.  Only trivially copyable weight types such as int and double can
+// be stored this way.
+
+struct BinaryGraphHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t weightSize;
+  std::uint32_t weightKind;
+  std::uint32_t reserved;      // written as zero
+  std::uint64_t numVertices;
+  std::uint64_t numEdges;
+  std::uint64_t weightsOffset;
+  std::uint64_t checksum;
+  std::uint64_t unused;        // written as zero, pads the header to 64 bytes
+};
+
+static_assert(sizeof(BinaryGraphHeader) == 64);
+
+inline constexpr char binaryGraphMagic[8] {'I', 'P', 'Q', 'G', 'R', 'A', 'P', 'H'};
+inline constexpr std::uint32_t binaryGraphVersion = 1;
+
+// records what sort of number a weight is, so a file of doubles
+// cannot be opened as a graph of ints of the same size
+template <typename T>
+constexpr std::uint32_t binaryWeightKind() {
+  if constexpr (std::is_floating_point_v<T>) {
+    return 3;
+  } else if constexpr (std::is_unsigned_v<T>) {
+    return 2;
+  } else if constexpr (std::is_integral_v<T>) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+// 64-bit FNV-1a hash, continued from hash
+inline std::uint64_t fnv1a(const void* data, std::size_t length,
+                           std::uint64_t hash = 14695981039346656037ull) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < length; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// write any graph with the Graph<T> interface in the binary layout above
+template <typename T, template <typename> class GraphType>
+void writeBinaryGraph(const GraphType<T>& G, const std::string& outputFile) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "binary graphs need a trivially copyable weight type");
+  int N = G.size();
+  std::vector<std::int32_t> offsets(N + 1);
+  std::vector<std::int32_t> targets {};
+  std::vector<T> weights {};
+  std::vector<std::pair<int, T> > row {};
+  for (int v = 0; v < N; ++v) {
+    row.clear();
+    for (const auto& [neighbour, weight] : *(G.neighbours(v))) {
+      row.push_back({neighbour, weight});
+    }
+    // rows are kept sorted by target so lookups can binary search
+    std::sort(row.begin(), row.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (const auto& [neighbour, weight] : row) {
+      targets.push_back(neighbour);
+      weights.push_back(weight);
+    }
+    offsets.at(v + 1) = static_cast<std::int32_t>(targets.size());
+  }
+
+  std::uint64_t beforeWeights = sizeof(BinaryGraphHeader)
+      + sizeof(std::int32_t) * (offsets.size() + targets.size());
+  std::uint64_t padding = (8 - beforeWeights % 8) % 8;
+  const char zeros[8] {};
+
+  BinaryGraphHeader header {};
+  std::memcpy(header.magic, binaryGraphMagic, sizeof(header.magic));
+  header.version = binaryGraphVersion;
+  header.weightSize = sizeof(T);
+  header.weightKind = binaryWeightKind<T>();
+  header.numVertices = N;
+  header.numEdges = targets.size();
+  header.weightsOffset = beforeWeights + padding;
+  std::uint64_t hash = fnv1a(offsets.data(), sizeof(std::int32_t) * offsets.size());
+  hash = fnv1a(targets.data(), sizeof(std::int32_t) * targets.size(), hash);
+  hash = fnv1a(zeros, padding, hash);
+  hash = fnv1a(weights.data(), sizeof(T) * weights.size(), hash);
+  header.checksum = hash;
+
+  std::ofstream outfile {outputFile, std::ios::binary | std::ios::trunc};
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be opened for writing");
+  }
+  outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  outfile.write(reinterpret_cast<const char*>(offsets.data()),
+                sizeof(std::int32_t) * offsets.size());
+  outfile.write(reinterpret_cast<const char*>(targets.data()),
+                sizeof(std::int32_t) * targets.size());
+  outfile.write(zeros, padding);
+  outfile.write(reinterpret_cast<const char*>(weights.data()),
+                sizeof(T) * weights.size());
+  if (!outfile) {
+    throw std::runtime_error(outputFile + " could not be written");
+  }
+}
+
+// A read-only graph backed by a memory mapped binary graph file.
+// Opening only checks the header, the arrays are used in place and are
+// paged in by the operating system as the graph is used.  It has the
+// read-only interface of Graph<T>, like CompactGraph<T>.
+template <typename T>
+class MappedGraph {
+ private:
+  void* mapping {nullptr};
+  std::size_t mappingLength {};
+  const int* offsets {nullptr};
+  const int* targets {nullptr};
+  const T* weights {nullptr};
+  int numVertices {};
+  int numEdges_ {};
+  std::uint64_t checksum {};
+  mutable std::shared_ptr<const CompactGraph<T> > reversed {};
+
+ public:
+  // map filename, throws std::runtime_error if it is not a valid
+  // binary graph with weights of type T.  The header and the row offsets
+  // are checked, the targets and weights are not: a file that may be
+  // damaged or untrusted should pass verifyChecksum() before it is used.
+  explicit MappedGraph(const std::string& filename);
+
+  MappedGraph(const MappedGraph&) = delete;
+  MappedGraph& operator=(const MappedGraph&) = delete;
+  MappedGraph(MappedGraph&& other) noexcept;
+  MappedGraph& operator=(MappedGraph&& other) noexcept;
+  ~MappedGraph();
+
+  // is there an edge from vertex i to vertex j?
+  bool isEdge(int i, int j) const;
+
+  // return weight of edge from i to j
+  // will throw an exception if there is no edge from i to j
+  T getEdgeWeight(int i, int j) const;
+
+  // returns number of vertices in the graph
+  int size() const;
+
+  // returns number of edges in the graph
+  int numEdges() const;
+
+  // hash the arrays and compare with the checksum in the header.
+  // This reads the whole file, so it is not done when opening.
+  bool verifyChecksum() const;
+
+  // the graph with every edge turned around, held in memory since the
+  // file only stores outgoing edges.  Built on the first call and kept,
+  // the first call is not thread safe
+  const CompactGraph<T>& reverse() const;
+
+  const int* offsetData() const {
+    return offsets;
+  }
+
+  const int* targetData() const {
+    return targets;
+  }
+
+  const T* weightData() const {
+    return weights;
+  }
+
+  using iterator = CompactRowIterator<T>;
+
+  iterator begin() const {
+    return {offsets, targets, weights, 0};
+  }
+
+  iterator end() const {
+    return {offsets, targets, weights, numVertices};
+  }
+
+  // return iterator to a particular vertex
+  iterator neighbours(int a) const {
+    return begin() + a;
+  }
+
+ private:
+  void unmap();
+};
+
+template <typename T>
+MappedGraph<T>::MappedGraph(const std::string& inputFile) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "binary graphs need a trivially copyable weight type");
+  int fd = ::open(inputFile.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(inputFile + " could not be opened");
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) != 0
+      or static_cast<std::size_t>(info.st_size) < sizeof(BinaryGraphHeader)) {
+    ::close(fd);
+    throw std::runtime_error(inputFile + " is not a binary graph");
+  }
+  mappingLength = info.st_size;
+  mapping = ::mmap(nullptr, mappingLength, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file alive, the descriptor is not needed
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    mapping = nullptr;
+    throw std::runtime_error(inputFile + " could not be mapped");
+  }
+
+  const char* base = static_cast<const char*>(mapping);
+  BinaryGraphHeader header {};
+  std::memcpy(&header, base, sizeof(header));
+  std::uint64_t N = header.numVertices;
+  std::uint64_t E = header.numEdges;
+  std::uint64_t expectedWeightsOffset = sizeof(BinaryGraphHeader)
+      + sizeof(std::int32_t) * (N + 1 + E);
+  expectedWeightsOffset += (8 - expectedWeightsOffset % 8) % 8;
+  std::string problem {};
+  if (std::memcmp(header.magic, binaryGraphMagic, sizeof(header.magic)) != 0) {
+    problem = " is not a binary graph";
+  } else if (header.version != binaryGraphVersion) {
+    problem = " has an unsupported binary graph version";
+  } else if (header.weightSize != sizeof(T)
+             or header.weightKind != binaryWeightKind<T>()) {
+    problem = " holds a different weight type";
+  } else if (N >= static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+             or E > static_cast<std::uint64_t>(std::numeric_limits<int>::max())
+             or header.weightsOffset != expectedWeightsOffset
+             or mappingLength != expectedWeightsOffset + sizeof(T) * E) {
+    problem = " is truncated or corrupt";
+  }
+  const int* rowOffsets =
+      reinterpret_cast<const int*>(base + sizeof(BinaryGraphHeader));
+  // the rows must tile the targets array, or neighbours() would read
+  // outside it; this reads only the offsets, N + 1 ints
+  if (problem.empty()
+      and (rowOffsets[0] != 0 or rowOffsets[N] != static_cast<int>(E))) {
+    problem = " is truncated or corrupt";
+  }
+  for (std::uint64_t v = 0; problem.empty() and v < N; ++v) {
+    if (rowOffsets[v + 1] < rowOffsets[v]) {
+      problem = " is truncated or corrupt";
+    }
+  }
+  if (not problem.empty()) {
+    unmap();
+    throw std::runtime_error(inputFile + problem);
+  }
+
+  numVertices = static_cast<int>(N);
+  numEdges_ = static_cast<int>(E);
+  checksum = header.checksum;
+  offsets = rowOffsets;
+  targets = offsets + (N + 1);
+  weights = reinterpret_cast<const T*>(base + header.weightsOffset);
+}
+
+template <typename T>
+MappedGraph<T>::MappedGraph(MappedGraph&& other) noexcept {
+  *this = std::move(other);
+}
+
+template <typename T>
+MappedGraph<T>& MappedGraph<T>::operator=(MappedGraph&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    mapping = std::exchange(other.mapping, nullptr);
+    mappingLength = std::exchange(other.mappingLength, 0);
+    offsets = std::exchange(other.offsets, nullptr);
+    targets = std::exchange(other.targets, nullptr);
+    weights = std::exchange(other.weights, nullptr);
+    numVertices = std::exchange(other.numVertices, 0);
+    numEdges_ = std::exchange(other.numEdges_, 0);
+    checksum = other.checksum;
+    reversed = std::move(other.reversed);
+  }
+  return *this;
+}
+
+template <typename T>
+MappedGraph<T>::~MappedGraph() {
+  unmap();
+}
+
+template <typename T>
+void MappedGraph<T>::unmap() {
+  if (mapping != nullptr) {
+    ::munmap(mapping, mappingLength);
+    mapping = nullptr;
+  }
+}
+
+template <typename T>
+int MappedGraph<T>::size() const {
+  return numVertices;
+}
+
+template <typename T>
+int MappedGraph<T>::numEdges() const {
+  return numEdges_;
+}
+
+template <typename T>
+bool MappedGraph<T>::isEdge(int i, int j) const {
+  if (i >= 0 && i < numVertices && j >= 0 && j < numVertices) {
+    auto row = *neighbours(i);
+    return row.find(j) != row.end();
+  }
+  return false;
+}
+
+template <typename T>
+T MappedGraph<T>::getEdgeWeight(int i, int j) const {
+  if (i < 0 or i >= numVertices) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  auto row = *neighbours(i);
+  auto it = row.find(j);
+  if (it == row.end()) {
+    throw std::out_of_range("no edge between these vertices");
+  }
+  return it.weight();
+}
+
+template <typename T>
+const CompactGraph<T>& MappedGraph<T>::reverse() const {
+  if (!reversed) {
+    reversed = std::make_shared<const CompactGraph<T> >(
+        CompactGraph<T>::reverseOf(*this));
+  }
+  return *reversed;
+}
+
+template <typename T>
+bool MappedGraph<T>::verifyChecksum() const {
+  if (mapping == nullptr) {
+    return false;
+  }
+  const char* base = static_cast<const char*>(mapping);
+  return fnv1a(base + sizeof(BinaryGraphHeader),
+               mappingLength - sizeof(BinaryGraphHeader)) == checksum;
+}
+
+#endif      // GRAPH_BINARY_HPP_
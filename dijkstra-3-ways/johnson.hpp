@@ -0,0 +1,183 @@
+#ifndef JOHNSON_HPP_
+#define JOHNSON_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "graph.hpp"
+#include "compact_graph.hpp"
+#include "graph_binary.hpp"
+#include "bellman_ford.hpp"
+#include "distance_matrix.hpp"
+#include "thread_pool.hpp"
+
+// Johnson's algorithm for all pairs shortest paths with negative weights
+// but no negative cycles.  One Bellman-Ford pass from an extra vertex with
+// a 0 edge to every vertex gives potentials h with
+//   w(u, v) + h(u) - h(v) >= 0
+// for every edge.  With those weights Dijkstra works, and a path from s to
+// t only changes length by h(s) - h(t), so
+//   d(s, t) = d'(s, t) - h(s) + h(t).
+// The N searches on the reweighted graph are the rows of a distance
+// matrix and run in parallel like distanceMatrix.
+//
+// Throws std::invalid_argument if the graph has a negative cycle.
+
+// potentials making every edge weight non-negative
+template <typename T, template <typename> class GraphType>
+std::vector<T> johnsonPotentials(const GraphType<T>& G,
+                                 int numThreads = defaultThreadCount()) {
+  int N = G.size();
+  Graph<T> withSource {N + 1};
+  for (int u = 0; u < N; ++u) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(u))) {
+      withSource.addEdge(u, neighbour, weight);
+    }
+    withSource.addEdge(N, u, T {});
+  }
+  NegativeWeightResult<T> result {bellmanFord(withSource, N, numThreads)};
+  if (result.hasNegativeCycle()) {
+    throw std::invalid_argument("graph has a negative cycle");
+  }
+  std::vector<T> potential {result.tree.distances()};
+  potential.pop_back();
+  return potential;
+}
+
+// G with weights w(u, v) + h(u) - h(v).  Rounding can leave a double a
+// hair below 0, which is taken as 0
+template <typename T, template <typename> class GraphType>
+CompactGraph<T> reweightedGraph(const GraphType<T>& G,
+                                const std::vector<T>& potential) {
+  Graph<T> H {G.size()};
+  for (int u = 0; u < G.size(); ++u) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(u))) {
+      T reweighted = distanceGap(weight + potential.at(u), potential.at(neighbour));
+      H.addEdge(u, neighbour, std::max(T {}, reweighted));
+    }
+  }
+  return CompactGraph<T> {H};
+}
+
+namespace johnson_detail {
+
+// turn rows of reweighted distances from the given sources into distances
+template <typename T>
+void restoreRows(T* rows, int firstRow, int lastRow,
+                 const std::vector<T>& potential) {
+  int N = static_cast<int>(potential.size());
+  for (int source = firstRow; source < lastRow; ++source) {
+    T* row = rows + static_cast<std::size_t>(source - firstRow) * N;
+    for (int target = 0; target < N; ++target) {
+      if (row[target] != infinity<T>()) {
+        row[target] = distanceGap(row[target] + potential[target],
+                                  potential[source]);
+      }
+    }
+  }
+}
+
+}  // namespace johnson_detail
+
+// distances between all pairs of vertices in a dense matrix, entry
+// (s, t) the distance from s to t
+template <typename T, template <typename> class GraphType>
+DistanceMatrix<T> allPairsShortestPaths(const GraphType<T>& G,
+                                        int numThreads = defaultThreadCount()) {
+  std::vector<T> potential {johnsonPotentials(G, numThreads)};
+  CompactGraph<T> reweighted {reweightedGraph(G, potential)};
+  std::vector<int> vertices(G.size());
+  std::iota(vertices.begin(), vertices.end(), 0);
+  DistanceMatrix<T> matrix {distanceMatrix(reweighted, vertices, vertices,
+                                           numThreads)};
+  johnson_detail::restoreRows(matrix.row(0), 0, G.size(), potential);
+  return matrix;
+}
+
+// All pairs distances written to outputFile in the format of
+// DistanceMatrix<T>::save().  The file is mapped into memory and the
+// searches write their rows straight into it, rowsPerBlock rows at a time,
+// so the matrix is never held in memory besides the file; the kernel
+// writes pages back as it needs to.  Throws std::runtime_error if the
+// file cannot be created or mapped.
+template <typename T, template <typename> class GraphType>
+void allPairsShortestPathsToFile(const GraphType<T>& G,
+                                 const std::string& outputFile,
+                                 int numThreads = defaultThreadCount(),
+                                 int rowsPerBlock = 256) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "saved distance matrices need a trivially copyable weight type");
+  using namespace distance_matrix_detail;
+  if (rowsPerBlock < 1) {
+    throw std::invalid_argument("rowsPerBlock must be positive");
+  }
+  int N = G.size();
+  std::vector<T> potential {johnsonPotentials(G, numThreads)};
+  CompactGraph<T> reweighted {reweightedGraph(G, potential)};
+  std::vector<int> vertices(N);
+  std::iota(vertices.begin(), vertices.end(), 0);
+  std::vector<char> isTarget {};
+  int distinctTargets = markTargets(reweighted, vertices, vertices, isTarget);
+  numThreads = std::max(1, std::min(numThreads, N));
+  ThreadPool pool {numThreads};
+  std::vector<DijkstraWorkspace<T> > workspaces(numThreads,
+                                                DijkstraWorkspace<T>(N));
+
+  std::size_t entriesLength = sizeof(T) * N * static_cast<std::size_t>(N);
+  std::size_t mappingLength = sizeof(DistanceMatrixHeader) + entriesLength;
+  int fd = ::open(outputFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error(outputFile + " could not be opened for writing");
+  }
+  if (::ftruncate(fd, static_cast<off_t>(mappingLength)) != 0) {
+    ::close(fd);
+    throw std::runtime_error(outputFile + " could not be written");
+  }
+  void* mapping = ::mmap(nullptr, mappingLength, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+  // the mapping keeps the file alive, the descriptor is not needed
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error(outputFile + " could not be mapped");
+  }
+  char* base = static_cast<char*>(mapping);
+  T* entries = reinterpret_cast<T*>(base + sizeof(DistanceMatrixHeader));
+  std::uint64_t hash = fnv1a(nullptr, 0);
+  try {
+    for (int firstRow = 0; firstRow < N; firstRow += rowsPerBlock) {
+      int lastRow = std::min(N, firstRow + rowsPerBlock);
+      T* block = entries + static_cast<std::size_t>(firstRow) * N;
+      fillRows(reweighted, vertices, firstRow, lastRow, vertices, isTarget,
+               distinctTargets, workspaces, pool, block);
+      johnson_detail::restoreRows(block, firstRow, lastRow, potential);
+      hash = fnv1a(block, sizeof(T) * (lastRow - firstRow) * N, hash);
+    }
+  } catch (...) {
+    ::munmap(mapping, mappingLength);
+    throw;
+  }
+  DistanceMatrixHeader header {};
+  std::memcpy(header.magic, distanceMatrixMagic, sizeof(header.magic));
+  header.version = distanceMatrixVersion;
+  header.weightSize = sizeof(T);
+  header.weightKind = binaryWeightKind<T>();
+  header.numRows = N;
+  header.numColumns = N;
+  header.checksum = hash;
+  std::memcpy(base, &header, sizeof(header));
+  bool written = ::msync(mapping, mappingLength, MS_SYNC) == 0;
+  ::munmap(mapping, mappingLength);
+  if (!written) {
+    throw std::runtime_error(outputFile + " could not be written");
+  }
+}
+
+#endif      // JOHNSON_HPP_
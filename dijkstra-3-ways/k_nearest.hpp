@@ -0,0 +1,128 @@
+#ifndef K_NEAREST_HPP_
+#define K_NEAREST_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "graph.hpp"
+#include "dijkstra_workspace.hpp"
+#include "thread_pool.hpp"
+
+// The k points of interest (POIs) nearest to a source: workspaceSearch
+// stopping as soon as k POIs are settled.  Vertices
+// are settled in order of distance, so those are the k nearest, found
+// without a full shortest path tree or any sorting.
+//
+// The POIs are given either as a bitmap, poiBitmap[v] true for a POI, or
+// as a sorted vector of vertex numbers.  The bitmap answers "is v a POI"
+// in constant time and suits large POI sets; the sorted vector is a
+// binary search away from the answer and takes memory only for the POIs.
+
+template <typename T>
+struct NearbyVertex {
+  int vertex {};
+  T distance {};
+};
+
+namespace k_nearest_detail {
+
+template <typename T, template <typename> class GraphType, typename IsPoi>
+std::vector<NearbyVertex<T> > search(const GraphType<T>& G, int source, int k,
+                                     DijkstraWorkspace<T>& workspace,
+                                     const IsPoi& isPoi) {
+  if (source < 0 or source >= G.size()) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  if (k < 0) {
+    throw std::invalid_argument("k must not be negative");
+  }
+  std::vector<NearbyVertex<T> > nearest {};
+  if (k == 0) {
+    return nearest;
+  }
+  workspaceSearch(G, source, workspace, NeverStop {},
+                  [&](int current, const T& dist) {
+                    if (!isPoi(current)) {
+                      return false;
+                    }
+                    nearest.push_back({current, dist});
+                    return static_cast<int>(nearest.size()) == k;
+                  });
+  return nearest;
+}
+
+// "is v a POI" for either kind of POI set, after checking the set
+template <typename T, template <typename> class GraphType>
+auto membership(const GraphType<T>& G, const std::vector<bool>& poiBitmap) {
+  if (static_cast<int>(poiBitmap.size()) != G.size()) {
+    throw std::invalid_argument("POI bitmap is for a different graph");
+  }
+  return [&poiBitmap](int v) { return static_cast<bool>(poiBitmap[v]); };
+}
+
+template <typename T, template <typename> class GraphType>
+auto membership(const GraphType<T>& G, const std::vector<int>& sortedPois) {
+  if (!std::is_sorted(sortedPois.begin(), sortedPois.end())) {
+    throw std::invalid_argument("POIs must be sorted");
+  }
+  if (!sortedPois.empty()
+      and (sortedPois.front() < 0 or sortedPois.back() >= G.size())) {
+    throw std::out_of_range("invalid vertex number");
+  }
+  return [&sortedPois](int v) {
+    return std::binary_search(sortedPois.begin(), sortedPois.end(), v);
+  };
+}
+
+}  // namespace k_nearest_detail
+
+// The k POIs nearest to source with their distances, nearest first.
+// Fewer if fewer than k POIs can be reached; the source counts if it is a
+// POI.  PoiSet is std::vector<bool> (a bitmap) or a sorted std::vector<int>.
+template <typename PoiSet, typename T, template <typename> class GraphType>
+std::vector<NearbyVertex<T> > kNearest(const GraphType<T>& G, int source,
+                                       const PoiSet& pois, int k,
+                                       DijkstraWorkspace<T>& workspace) {
+  return k_nearest_detail::search(G, source, k, workspace,
+                                  k_nearest_detail::membership(G, pois));
+}
+
+// one off query, allocating the workspace for it
+template <typename PoiSet, typename T, template <typename> class GraphType>
+std::vector<NearbyVertex<T> > kNearest(const GraphType<T>& G, int source,
+                                       const PoiSet& pois, int k) {
+  DijkstraWorkspace<T> workspace(G.size());
+  return kNearest(G, source, pois, k, workspace);
+}
+
+// kNearest for every source, on numThreads threads with one workspace per
+// thread (see effectiveThreads)
+template <typename PoiSet, typename T, template <typename> class GraphType>
+std::vector<std::vector<NearbyVertex<T> > > kNearestBatch(
+    const GraphType<T>& G, const std::vector<int>& sources, const PoiSet& pois,
+    int k, int numThreads = defaultThreadCount()) {
+  auto isPoi {k_nearest_detail::membership(G, pois)};
+  for (int source : sources) {
+    if (source < 0 or source >= G.size()) {
+      throw std::out_of_range("invalid vertex number");
+    }
+  }
+  int numSources = static_cast<int>(sources.size());
+  numThreads = std::min(effectiveThreads<T>(numThreads), std::max(1, numSources));
+  std::vector<std::vector<NearbyVertex<T> > > answers(numSources);
+  std::vector<DijkstraWorkspace<T> > workspaces(numThreads,
+                                                DijkstraWorkspace<T>(G.size()));
+  std::atomic<int> nextSource {0};
+  ThreadPool pool {numThreads};
+  pool.run([&](int thread) {
+    for (int i = nextSource++; i < numSources; i = nextSource++) {
+      answers[i] = k_nearest_detail::search(G, sources[i], k,
+                                            workspaces.at(thread), isPoi);
+    }
+  });
+  return answers;
+}
+
+#endif      // K_NEAREST_HPP_
@@ -3,7 +3,31 @@
 #include <vector>
 #include <algorithm>
 #include <random>
+#include <filesystem>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include "graph.hpp"
+#include "compact_graph.hpp"
+#include "graph_binary.hpp"
+#include "bucket_dijkstra.hpp"
+#include "radix_heap.hpp"
+#include "dijkstra_workspace.hpp"
+#include "bidirectional_dijkstra.hpp"
+#include "astar.hpp"
+#include "contraction_hierarchy.hpp"
+#include "alt.hpp"
+#include "distance_matrix.hpp"
+#include "query_executor.hpp"
+#include "bounded_dijkstra.hpp"
+#include "k_nearest.hpp"
+#include "dynamic_sssp.hpp"
+#include "bellman_ford.hpp"
+#include "johnson.hpp"
 #include "my_integer.hpp"
 
 // First 9 test cases are lazy (int, MyInteger, double, respectively).
@@ -400,6 +424,2056 @@ TEST(LazyDoubleRandomGraphTest, singleSourceLazy) {
 }
 
 
+TEST(CompactGraphTest, sameEdgesAsGraph) {
+  Graph<double> G {"tinyEWD.txt"};
+  CompactGraph<double> fromGraph {G};
+  CompactGraph<double> fromFile {"tinyEWD.txt"};
+  ASSERT_EQ(fromGraph.size(), G.size());
+  ASSERT_EQ(fromFile.size(), G.size());
+  EXPECT_EQ(fromGraph.numEdges(), 15);
+  EXPECT_EQ(fromFile.numEdges(), 15);
+  EXPECT_TRUE(isSubgraph(fromGraph, G));
+  EXPECT_TRUE(isSubgraph(G, fromGraph));
+  EXPECT_TRUE(isSubgraph(fromFile, G));
+  EXPECT_TRUE(isSubgraph(G, fromFile));
+  EXPECT_TRUE(fromFile.isEdge(4, 5));
+  EXPECT_FALSE(fromFile.isEdge(0, 1));
+  EXPECT_FALSE(fromFile.isEdge(-1, 0));
+  EXPECT_DOUBLE_EQ(fromFile.getEdgeWeight(4, 5), 35.0);
+  EXPECT_THROW(fromFile.getEdgeWeight(0, 1), std::out_of_range);
+}
+
+TEST(CompactGraphTest, duplicateEdgesKeepFirstWeight) {
+  Graph<int> G {3};
+  G.addEdge(0, 2, 7);
+  G.addEdge(0, 2, 1);
+  G.addEdge(0, 1, 3);
+  CompactGraph<int> C {G};
+  EXPECT_EQ(C.numEdges(), 2);
+  EXPECT_EQ(C.getEdgeWeight(0, 2), 7);
+  EXPECT_TRUE(C.neighbours(1)->empty());
+  EXPECT_EQ((*C.neighbours(0)).size(), 2);
+}
+
+// the same shortest path lengths come out whichever graph we run on
+template <typename T>
+void compactMatchesGraph(const Graph<T>& G) {
+  CompactGraph<T> C {G};
+  auto fromGraph {pathLengthsFromRoot(singleSourceIndex(G, 0), 0)};
+  for (const auto& shortestPath : {singleSourceIndex(C, 0),
+                                   singleSourceLazy(C, 0)}) {
+    EXPECT_TRUE(isSubgraph(shortestPath, C));
+    EXPECT_TRUE(isSubgraph(shortestPath, G));
+    EXPECT_TRUE(isTreePlusIsolated(shortestPath, 0));
+    auto bestDistanceTo {pathLengthsFromRoot(shortestPath, 0)};
+    EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, C, 0));
+    EXPECT_EQ(bestDistanceTo, fromGraph);
+  }
+  EXPECT_EQ(singleSourceLazyDistance(C, 0), fromGraph);
+}
+
+TEST(CompactGraphTest, tinyEWD) {
+  compactMatchesGraph(Graph<double> {"tinyEWD.txt"});
+  compactMatchesGraph(Graph<MyInteger> {"tinyEWD.txt"});
+}
+
+TEST(CompactGraphTest, mediumEWD) {
+  compactMatchesGraph(Graph<int> {"mediumEWD.txt"});
+  compactMatchesGraph(Graph<double> {"mediumEWD.txt"});
+}
+
+TEST(CompactGraphTest, randomGraph) {
+  compactMatchesGraph(randomGraph(300, 77, 0.1));
+}
+
+TEST(GraphReaderTest, detectsFormat) {
+  std::string ewd {"3\n0 1 2\n"};
+  std::string dimacs {"c comment\np sp 3 1\na 1 2 2\n"};
+  EXPECT_EQ(detectFormat(ewd.data(), ewd.data() + ewd.size()),
+            GraphFileFormat::EWD);
+  EXPECT_EQ(detectFormat(dimacs.data(), dimacs.data() + dimacs.size()),
+            GraphFileFormat::DIMACS);
+}
+
+TEST(GraphReaderTest, dimacsIdsStartAtOne) {
+  std::string dimacs {"c comment\np sp 3 2\na 1 2 7\na 3 1 11712\n"};
+  EdgeList edges {parseEdgeList(dimacs.data(), dimacs.data() + dimacs.size(), 1)};
+  ASSERT_EQ(edges.numVertices, 3);
+  ASSERT_EQ(edges.numEdges(), 2);
+  EXPECT_EQ(edges.from, (std::vector<int> {0, 2}));
+  EXPECT_EQ(edges.to, (std::vector<int> {1, 0}));
+  EXPECT_EQ(edges.weights, (std::vector<double> {7, 11712}));
+}
+
+TEST(GraphReaderTest, ewdNumbers) {
+  std::string ewd {"4\n5\n0 1 0.35\r\n1 2 -1.5e2\n  2 3 .25\n3 0 12\n"};
+  EdgeList edges {parseEdgeList(ewd.data(), ewd.data() + ewd.size(), 1)};
+  ASSERT_EQ(edges.numVertices, 4);
+  EXPECT_EQ(edges.weights, (std::vector<double> {0.35, -150, 0.25, 12}));
+  std::string bad {"2\n0 2 1\n"};
+  EXPECT_THROW(parseEdgeList(bad.data(), bad.data() + bad.size(), 1),
+               std::out_of_range);
+}
+
+TEST(GraphReaderTest, chunksKeepFileOrder) {
+  Graph<int> G {randomGraph(60, 9, 0.3)};
+  std::string dimacs {"p sp 60 0\n"};
+  for (int i = 0; i < G.size(); ++i) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(i))) {
+      dimacs += "a " + std::to_string(i + 1) + ' '
+                + std::to_string(neighbour + 1) + ' '
+                + std::to_string(weight) + '\n';
+    }
+  }
+  EdgeList oneThread {parseEdgeList(dimacs.data(), dimacs.data() + dimacs.size(), 1)};
+  for (int numThreads : {2, 3, 7, 64}) {
+    EdgeList edges {parseEdgeList(dimacs.data(), dimacs.data() + dimacs.size(),
+                                  numThreads)};
+    EXPECT_EQ(edges.numVertices, 60);
+    EXPECT_EQ(edges.from, oneThread.from);
+    EXPECT_EQ(edges.to, oneThread.to);
+    EXPECT_EQ(edges.weights, oneThread.weights);
+  }
+}
+
+TEST(GraphReaderTest, dimacsFileMatchesEWD) {
+  Graph<int> ewd {"tinyEWD.txt"};
+  Graph<int> dimacs {"tinyEWD.gr"};
+  ASSERT_EQ(dimacs.size(), 8);
+  EXPECT_TRUE(isSubgraph(ewd, dimacs));
+  EXPECT_TRUE(isSubgraph(dimacs, ewd));
+  CompactGraph<int> compact {"tinyEWD.gr"};
+  EXPECT_EQ(compact.numEdges(), 15);
+  EXPECT_TRUE(isSubgraph(compact, ewd));
+}
+
+// path for a scratch file in the system temporary directory
+std::string scratchFile(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+TEST(MappedGraphTest, roundTripMediumEWD) {
+  Graph<int> G {"mediumEWD.txt"};
+  std::string filename {scratchFile("mediumEWD.bin")};
+  writeBinaryGraph(G, filename);
+  MappedGraph<int> M {filename};
+  ASSERT_EQ(M.size(), G.size());
+  EXPECT_EQ(M.numEdges(), CompactGraph<int> {G}.numEdges());
+  EXPECT_TRUE(M.verifyChecksum());
+  EXPECT_TRUE(isSubgraph(M, G));
+  EXPECT_TRUE(isSubgraph(G, M));
+  EXPECT_EQ(M.getEdgeWeight(244, 246), 11712);
+  EXPECT_THROW(M.getEdgeWeight(0, 0), std::out_of_range);
+  auto bestDistanceTo {pathLengthsFromRoot(singleSourceIndex(M, 0), 0)};
+  EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, 0));
+  EXPECT_EQ(bestDistanceTo, pathLengthsFromRoot(singleSourceIndex(G, 0), 0));
+  std::filesystem::remove(filename);
+}
+
+TEST(MappedGraphTest, writeFromCompactAndMove) {
+  CompactGraph<double> C {"tinyEWD.txt"};
+  std::string filename {scratchFile("tinyEWD.bin")};
+  writeBinaryGraph(C, filename);
+  MappedGraph<double> first {filename};
+  MappedGraph<double> M {std::move(first)};
+  EXPECT_EQ(first.size(), 0);
+  EXPECT_EQ(M.numEdges(), 15);
+  EXPECT_TRUE(isSubgraph(M, C));
+  EXPECT_TRUE(isSubgraph(C, M));
+  std::filesystem::remove(filename);
+}
+
+TEST(MappedGraphTest, rejectsBadFiles) {
+  Graph<int> G {"tinyEWD.txt"};
+  std::string filename {scratchFile("tinyEWD_int.bin")};
+  writeBinaryGraph(G, filename);
+  // weights were written as int
+  EXPECT_THROW(MappedGraph<double> {filename}, std::runtime_error);
+  EXPECT_THROW(MappedGraph<int> {"tinyEWD.txt"}, std::runtime_error);
+  EXPECT_THROW(MappedGraph<int> {scratchFile("no_such_graph.bin")},
+               std::runtime_error);
+  // flip a byte in the last weight, the header is still fine
+  {
+    std::fstream file {filename, std::ios::in | std::ios::out | std::ios::binary};
+    file.seekp(-1, std::ios::end);
+    file.put('\x7f');
+  }
+  MappedGraph<int> M {filename};
+  EXPECT_FALSE(M.verifyChecksum());
+  std::filesystem::resize_file(filename, std::filesystem::file_size(filename) - 4);
+  EXPECT_THROW(MappedGraph<int> {filename}, std::runtime_error);
+  std::filesystem::remove(filename);
+}
+
+// a body whose offsets do not tile the targets array is rejected when
+// opening, even though the header is fine
+TEST(MappedGraphTest, rejectsBadOffsets) {
+  Graph<int> G {"tinyEWD.txt"};
+  std::string filename {scratchFile("tinyEWD_offsets.bin")};
+  auto writeOffset = [&filename](int v, std::int32_t offset) {
+    std::fstream file {filename, std::ios::in | std::ios::out | std::ios::binary};
+    file.seekp(sizeof(BinaryGraphHeader) + sizeof(std::int32_t) * v);
+    file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+  };
+  int N = G.size();
+  writeBinaryGraph(G, filename);
+  // the rows of 0 and 1 overlap
+  writeOffset(1, 1000);
+  EXPECT_THROW(MappedGraph<int> {filename}, std::runtime_error);
+  writeBinaryGraph(G, filename);
+  writeOffset(0, 1);
+  EXPECT_THROW(MappedGraph<int> {filename}, std::runtime_error);
+  writeBinaryGraph(G, filename);
+  writeOffset(N, 14);
+  EXPECT_THROW(MappedGraph<int> {filename}, std::runtime_error);
+  writeBinaryGraph(G, filename);
+  MappedGraph<int> M {filename};
+  EXPECT_EQ(M.numEdges(), 15);
+  std::filesystem::remove(filename);
+}
+
+// Benchmarks for the arity of the index priority queue.  Each one runs
+// singleSourceIndex with a binary, 4-ary and 8-ary heap, checks they agree
+// and prints the running time and the number of comparisons of priorities.
+template <int Arity, typename T>
+std::vector<T> runArity(const CompactGraph<T>& G, int repeats) {
+  std::vector<T> bestDistanceTo {};
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; ++r) {
+    auto shortestPath {singleSourceIndexWith<IndexPriorityQueue<T, Arity> >(G, 0)};
+    bestDistanceTo = pathLengthsFromRoot(shortestPath, 0);
+  }
+  auto stop = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = stop - start;
+  std::cout << "arity " << Arity << ": " << elapsed.count() / repeats
+            << " ms per search\n";
+  return bestDistanceTo;
+}
+
+template <typename T>
+void arityBenchmark(const CompactGraph<T>& G, int repeats) {
+  auto binary {runArity<2>(G, repeats)};
+  EXPECT_TRUE(allEdgesRelaxed(binary, G, 0));
+  EXPECT_EQ(runArity<4>(G, repeats), binary);
+  EXPECT_EQ(runArity<8>(G, repeats), binary);
+}
+
+template <int Arity>
+void arityComparisons(const Graph<MyInteger>& G) {
+  MyInteger::clearCounts();
+  singleSourceIndexWith<IndexPriorityQueue<MyInteger, Arity> >(G, 0);
+  std::cout << "arity " << Arity << ": " << MyInteger::comparisonCount
+            << " comparisons\n";
+}
+
+TEST(ArityBenchmark, mediumEWD) {
+  arityBenchmark(CompactGraph<int> {"mediumEWD.txt"}, 20);
+  Graph<MyInteger> G {"mediumEWD.txt"};
+  arityComparisons<2>(G);
+  arityComparisons<4>(G);
+  arityComparisons<8>(G);
+}
+
+TEST(ArityBenchmark, randomGraph) {
+  arityBenchmark(CompactGraph<int> {randomGraph(2000, 5, 0.01)}, 5);
+}
+
+// the NY road data is not kept in the repository
+TEST(ArityBenchmark, USAGraph) {
+  if (not std::filesystem::exists("USA-road-d.NY.gr")) {
+    GTEST_SKIP() << "USA-road-d.NY.gr not found";
+  }
+  arityBenchmark(CompactGraph<int> {"USA-road-d.NY.gr"}, 3);
+  Graph<MyInteger> G {"USA-road-d.NY.gr"};
+  arityComparisons<2>(G);
+  arityComparisons<4>(G);
+  arityComparisons<8>(G);
+}
+
+// Benchmarks for the layout of the heap: singleSourceIndex with the keys
+// looked up through the heap's indices (IndexPriorityQueue) and with the
+// keys packed into the heap entries (PackedIndexPriorityQueue)
+template <typename Queue, typename T>
+std::vector<T> runLayout(const CompactGraph<T>& G, int repeats,
+                         const std::string& name) {
+  std::vector<T> bestDistanceTo {};
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; ++r) {
+    bestDistanceTo = singleSourceIndexTreeWith<Queue>(G, 0).distances();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = stop - start;
+  std::cout << name << ": " << elapsed.count() / repeats << " ms per search\n";
+  return bestDistanceTo;
+}
+
+template <typename T>
+void layoutBenchmark(const CompactGraph<T>& G, int repeats) {
+  auto indirect {runLayout<IndexPriorityQueue<T> >(G, repeats, "indirect")};
+  auto packed {runLayout<PackedIndexPriorityQueue<T> >(G, repeats, "packed")};
+  EXPECT_EQ(packed, indirect);
+  using Packed4 = PackedIndexPriorityQueue<T, 4>;
+  EXPECT_EQ(runLayout<Packed4>(G, repeats, "packed 4-ary"), indirect);
+}
+
+TEST(HeapLayoutBenchmark, mediumEWD) {
+  layoutBenchmark(CompactGraph<int> {"mediumEWD.txt"}, 20);
+  layoutBenchmark(CompactGraph<double> {"mediumEWD.txt"}, 20);
+}
+
+TEST(HeapLayoutBenchmark, randomGraph) {
+  layoutBenchmark(CompactGraph<int> {randomGraph(3000, 6, 0.005)}, 5);
+}
+
+// the NY road data is not kept in the repository
+TEST(HeapLayoutBenchmark, USAGraph) {
+  if (not std::filesystem::exists("USA-road-d.NY.gr")) {
+    GTEST_SKIP() << "USA-road-d.NY.gr not found";
+  }
+  layoutBenchmark(CompactGraph<int> {"USA-road-d.NY.gr"}, 3);
+}
+
+// Benchmarks for the vectorised child minimum: singleSourceIndex on 4-ary
+// and 8-ary packed heaps with and without it.  Every vertex reached is
+// popped once, so the time is shown per vertex reached
+template <typename Queue, typename T>
+std::vector<T> runChildMinimum(const CompactGraph<T>& G, int repeats,
+                               const std::string& name) {
+  std::vector<T> bestDistanceTo {};
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; ++r) {
+    bestDistanceTo = singleSourceIndexTreeWith<Queue>(G, 0).distances();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::nano> elapsed = stop - start;
+  auto reached = std::count_if(bestDistanceTo.begin(), bestDistanceTo.end(),
+                               [](const T& d) { return d != infinity<T>(); });
+  std::cout << name << ": " << elapsed.count() / repeats / reached
+            << " ns per pop\n";
+  return bestDistanceTo;
+}
+
+template <typename T>
+void childMinimumBenchmark(const CompactGraph<T>& G, int repeats) {
+  using Scalar4 = PackedIndexPriorityQueue<T, 4, false>;
+  using Simd4 = PackedIndexPriorityQueue<T, 4, true>;
+  using Scalar8 = PackedIndexPriorityQueue<T, 8, false>;
+  using Simd8 = PackedIndexPriorityQueue<T, 8, true>;
+  auto expected {runChildMinimum<Scalar4>(G, repeats, "4-ary scalar")};
+  EXPECT_EQ(runChildMinimum<Simd4>(G, repeats, "4-ary simd"), expected);
+  EXPECT_EQ(runChildMinimum<Scalar8>(G, repeats, "8-ary scalar"), expected);
+  EXPECT_EQ(runChildMinimum<Simd8>(G, repeats, "8-ary simd"), expected);
+}
+
+TEST(ChildMinimumBenchmark, mediumEWD) {
+  childMinimumBenchmark(CompactGraph<float> {"mediumEWD.txt"}, 20);
+}
+
+TEST(ChildMinimumBenchmark, randomGraph) {
+  childMinimumBenchmark(CompactGraph<int> {randomGraph(3000, 7, 0.005)}, 5);
+}
+
+// the NY road data is not kept in the repository
+TEST(ChildMinimumBenchmark, USAGraph) {
+  if (not std::filesystem::exists("USA-road-d.NY.gr")) {
+    GTEST_SKIP() << "USA-road-d.NY.gr not found";
+  }
+  childMinimumBenchmark(CompactGraph<int> {"USA-road-d.NY.gr"}, 3);
+}
+
+TEST(DialTest, randomGraph) {
+  // randomGraph has weights from 1 to 10
+  Graph<int> G {randomGraph(500, 2353, 0.05)};
+  Graph<int> shortestPath {singleSourceDial<10>(G, 0)};
+  EXPECT_TRUE(isSubgraph(shortestPath, G));
+  EXPECT_TRUE(isTreePlusIsolated(shortestPath, 0));
+  auto bestDistanceTo {pathLengthsFromRoot(shortestPath, 0)};
+  EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, 0));
+  EXPECT_EQ(bestDistanceTo, pathLengthsFromRoot(singleSourceIndex(G, 0), 0));
+}
+
+TEST(DialTest, tinyEWDCompact) {
+  CompactGraph<int> G {"tinyEWD.txt"};
+  Graph<int> shortestPath {singleSourceDial<100>(G, 0)};
+  EXPECT_TRUE(isSubgraph(shortestPath, G));
+  EXPECT_TRUE(isTreePlusIsolated(shortestPath, 0));
+  auto bestDistanceTo {pathLengthsFromRoot(shortestPath, 0)};
+  EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, 0));
+  EXPECT_EQ(bestDistanceTo, pathLengthsFromRoot(singleSourceIndex(G, 0), 0));
+}
+
+TEST(DialTest, zeroWeightsAndUnreachable) {
+  Graph<int> G {6};
+  G.addEdge(0, 1, 0);
+  G.addEdge(1, 2, 0);
+  G.addEdge(0, 2, 1);
+  G.addEdge(2, 3, 3);
+  G.addEdge(1, 3, 3);
+  G.addEdge(5, 4, 1);
+  Graph<int> shortestPath {singleSourceDial<3>(G, 0)};
+  EXPECT_TRUE(isTreePlusIsolated(shortestPath, 0));
+  auto bestDistanceTo {pathLengthsFromRoot(shortestPath, 0)};
+  EXPECT_EQ(bestDistanceTo.at(2), 0);
+  EXPECT_EQ(bestDistanceTo.at(3), 3);
+  EXPECT_EQ(bestDistanceTo.at(4), infinity<int>());
+  EXPECT_TRUE(shortestPath.neighbours(5)->empty());
+}
+
+TEST(DialTest, weightTooLarge) {
+  Graph<int> G {3};
+  G.addEdge(0, 1, 4);
+  G.addEdge(1, 2, 11);
+  EXPECT_THROW(singleSourceDial<10>(G, 0), std::out_of_range);
+  G.removeEdge(1, 2);
+  G.addEdge(1, 2, -1);
+  EXPECT_THROW(singleSourceDial<10>(G, 0), std::out_of_range);
+}
+
+TEST(DialTest, boundedWeightsPicksEngine) {
+  Graph<double> G {"tinyEWD.txt"};
+  Graph<double> shortestPath {singleSourceBoundedWeights<100>(G, 0)};
+  EXPECT_TRUE(isSubgraph(shortestPath, G));
+  auto bestDistanceTo {pathLengthsFromRoot(shortestPath, 0)};
+  EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, 0));
+  Graph<int> H {"tinyEWD.txt"};
+  EXPECT_EQ(pathLengthsFromRoot(singleSourceBoundedWeights<100>(H, 0), 0),
+            pathLengthsFromRoot(singleSourceIndex(H, 0), 0));
+}
+
+TEST(RadixHeapTest, popsInOrder) {
+  RadixHeap<int> heap {};
+  for (int key : {7, 3, 3, 12, 0, 1000000, 5}) {
+    heap.push({key, key + 1});
+  }
+  ASSERT_EQ(heap.size(), 7);
+  std::vector<int> popped {};
+  bool pushedAgain = false;
+  while (!heap.empty()) {
+    auto [key, vertex] = heap.top();
+    EXPECT_EQ(vertex, key + 1);
+    popped.push_back(key);
+    heap.pop();
+    if (key == 5 and not pushedAgain) {
+      pushedAgain = true;
+      // pushes may go back down to the last key popped
+      heap.push({5, 6});
+      heap.push({9, 10});
+    }
+  }
+  EXPECT_EQ(popped, (std::vector<int> {0, 3, 3, 5, 5, 7, 9, 12, 1000000}));
+  heap.push({1000001, 0});
+  EXPECT_THROW(heap.push({17, 0}), std::invalid_argument);
+  EXPECT_THROW(heap.push({-1, 0}), std::invalid_argument);
+}
+
+TEST(RadixHeapTest, indexChangeKeyAndErase) {
+  IndexRadixHeap<MyInteger> heap(6);
+  heap.push(MyInteger {40}, 0);
+  heap.push(MyInteger {10}, 1);
+  heap.push(MyInteger {30}, 2);
+  heap.push(MyInteger {99}, 1);
+  EXPECT_EQ(heap.size(), 3);
+  EXPECT_EQ(heap.top().first, MyInteger {10});
+  heap.changeKey(MyInteger {20}, 0);
+  heap.changeKey(MyInteger {25}, 3);
+  heap.pop();
+  EXPECT_EQ(heap.top().second, 0);
+  EXPECT_THROW(heap.changeKey(MyInteger {5}, 2), std::invalid_argument);
+  EXPECT_TRUE(heap.contains(2));
+  heap.erase(0);
+  EXPECT_FALSE(heap.contains(0));
+  EXPECT_FALSE(heap.contains(6));
+  std::vector<int> order {};
+  while (!heap.empty()) {
+    order.push_back(heap.top().second);
+    heap.pop();
+  }
+  EXPECT_EQ(order, (std::vector<int> {3, 2}));
+}
+
+template <typename T>
+void radixMatchesIndex(const CompactGraph<T>& G) {
+  auto expected {pathLengthsFromRoot(singleSourceIndex(G, 0), 0)};
+  Graph<T> lazy {singleSourceLazyWith<RadixHeap<T> >(G, 0)};
+  Graph<T> index {singleSourceIndexWith<IndexRadixHeap<T> >(G, 0)};
+  for (const auto& shortestPath : {lazy, index}) {
+    EXPECT_TRUE(isSubgraph(shortestPath, G));
+    EXPECT_TRUE(isTreePlusIsolated(shortestPath, 0));
+    auto bestDistanceTo {pathLengthsFromRoot(shortestPath, 0)};
+    EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, 0));
+    EXPECT_EQ(bestDistanceTo, expected);
+  }
+}
+
+TEST(RadixHeapTest, dijkstraMediumEWD) {
+  radixMatchesIndex(CompactGraph<int> {"mediumEWD.txt"});
+  radixMatchesIndex(CompactGraph<MyInteger> {"mediumEWD.txt"});
+}
+
+TEST(RadixHeapTest, dijkstraRandomGraph) {
+  radixMatchesIndex(CompactGraph<int> {randomGraph(400, 31, 0.05)});
+}
+
+TEST(WorkspaceTest, reuseAcrossSources) {
+  CompactGraph<int> G {"mediumEWD.txt"};
+  DijkstraWorkspace<int> workspace(G.size());
+  for (int source : {0, 17, 249, 0, 123}) {
+    ASSERT_TRUE(singleSourceSearch(G, source, workspace));
+    auto expected {pathLengthsFromRoot(singleSourceIndex(G, source), source)};
+    std::vector<int> bestDistanceTo(G.size());
+    for (int v = 0; v < G.size(); ++v) {
+      bestDistanceTo.at(v) = workspace.distance(v);
+    }
+    EXPECT_EQ(bestDistanceTo, expected);
+    EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, source));
+  }
+}
+
+TEST(WorkspaceTest, stopAtTarget) {
+  Graph<double> G {"tinyEWD.txt"};
+  DijkstraWorkspace<double> workspace(G.size());
+  ASSERT_TRUE(singleSourceSearch(G, 0, workspace, 3));
+  EXPECT_DOUBLE_EQ(workspace.distance(3), 99.0);
+  EXPECT_EQ(workspace.pathTo(3), (std::vector<int> {0, 2, 7, 3}));
+  EXPECT_TRUE(workspace.settled(3));
+  // the search stopped before settling everything
+  EXPECT_FALSE(workspace.settled(1));
+  // a new query sees none of the old one
+  ASSERT_TRUE(singleSourceSearch(G, 7, workspace, 5));
+  EXPECT_DOUBLE_EQ(workspace.distance(5), 28.0);
+  EXPECT_FALSE(workspace.reached(0));
+  EXPECT_EQ(workspace.distance(0), infinity<double>());
+  EXPECT_EQ(workspace.parent(0), -1);
+  EXPECT_TRUE(workspace.pathTo(0).empty());
+  EXPECT_TRUE(workspace.queue().size() > 0);
+  workspace.reset();
+  EXPECT_TRUE(workspace.queue().empty());
+  EXPECT_TRUE(workspace.touched().empty());
+}
+
+TEST(WorkspaceTest, unreachableTarget) {
+  Graph<MyInteger> G {4};
+  G.addEdge(0, 1, MyInteger {3});
+  G.addEdge(2, 3, MyInteger {1});
+  DijkstraWorkspace<MyInteger> workspace(G.size());
+  EXPECT_FALSE(singleSourceSearch(G, 0, workspace, 3));
+  EXPECT_EQ(workspace.touched(), (std::vector<int> {0, 1}));
+  EXPECT_EQ(workspace.distance(1), MyInteger {3});
+}
+
+// The search builds one MyInteger per edge it looks at, the sum, and
+// moves it into the workspace; the queue gets one copy of it per
+// relaxation, assigned into its priority slot.  Reading the top takes no
+// copy at all.
+TEST(WorkspaceTest, searchDoesNotCopyPriorities) {
+  Graph<MyInteger> G {"mediumEWD.txt"};
+  DijkstraWorkspace<MyInteger> workspace(G.size());
+  singleSourceSearch(G, 0, workspace);
+  std::vector<MyInteger> expected {singleSourceIndexTree(G, 0).distances()};
+  // edges to vertices not yet settled, the ones the search relaxes
+  int edges = 0;
+  auto countEdges = [&](int v, const MyInteger&) {
+    for (const auto& edge : *(G.neighbours(v))) {
+      edges += !workspace.settled(edge.first);
+    }
+    return false;
+  };
+  MyInteger::clearCounts();
+  workspaceSearch(G, 0, workspace, NeverStop {}, countEdges);
+  // and the source's distance, in the workspace and in the queue
+  EXPECT_EQ(MyInteger::constructorCount, edges + 2);
+  EXPECT_EQ(MyInteger::copyCount, 0);
+  EXPECT_GT(MyInteger::assignmentCount, 0);
+  EXPECT_LE(MyInteger::assignmentCount, edges);
+  EXPECT_GT(MyInteger::moveCount, 0);
+  for (int v = 0; v < G.size(); ++v) {
+    ASSERT_EQ(workspace.distance(v), expected.at(v));
+  }
+}
+
+// number of edges leaving vertices with a finite distance, the edges a
+// full search looks at
+int edgesFromReached(const Graph<MyInteger>& G,
+                     const std::vector<MyInteger>& distances) {
+  int edges = 0;
+  for (int v = 0; v < G.size(); ++v) {
+    if (distances.at(v) != infinity<MyInteger>()) {
+      edges += static_cast<int>(G.neighbours(v)->size());
+    }
+  }
+  return edges;
+}
+
+// The engines in graph.hpp build one MyInteger per edge they look at, the
+// sum, besides their arrays, and copy it once per relaxation to give the
+// queue its key.  The other copies fill the distance array with infinity.
+TEST(WorkspaceTest, enginesDoNotCopyPriorities) {
+  Graph<MyInteger> G {"mediumEWD.txt"};
+  int N = G.size();
+  auto expected {singleSourceIndexTree(G, 0).distances()};
+  int edges = edgesFromReached(G, expected);
+  // infinity, and the source's distance and queue entry
+  int setup = 3;
+  MyInteger::clearCounts();
+  auto index {singleSourceIndexTree(G, 0)};
+  // and the queue's priorities and the parent edge weights
+  EXPECT_EQ(MyInteger::constructorCount, setup + 2 * N + edges);
+  // the queue's copy is assigned into its priority slot, as is the parent
+  // edge weight, so two assignments per relaxation
+  EXPECT_EQ(MyInteger::copyCount, N);
+  int relaxations = MyInteger::assignmentCount / 2;
+  EXPECT_LE(relaxations, edges);
+  MyInteger::clearCounts();
+  auto lazy {singleSourceLazyTree(G, 0)};
+  EXPECT_EQ(MyInteger::constructorCount, setup + N + edges);
+  // one assignment per relaxation, the parent edge weight
+  int lazyRelaxations = MyInteger::assignmentCount;
+  EXPECT_EQ(MyInteger::copyCount, N + lazyRelaxations);
+  std::vector<SourceOffset<MyInteger> > sources {{0, MyInteger {0}}};
+  MyInteger::clearCounts();
+  auto forest {multiSourceIndexTree(G, sources)};
+  // no queue entry for the source, which comes in through assign with one
+  // copy for the seed; its offset is assigned to bestDistanceTo and to the
+  // queue
+  EXPECT_EQ(MyInteger::constructorCount, setup - 1 + 2 * N + edges);
+  EXPECT_EQ(MyInteger::copyCount, N + 1);
+  EXPECT_EQ(MyInteger::assignmentCount, 2 * relaxations + 2);
+  MyInteger::clearCounts();
+  auto distances {singleSourceLazyDistance(G, 0)};
+  EXPECT_EQ(MyInteger::constructorCount, setup + edges);
+  EXPECT_EQ(MyInteger::copyCount, N + lazyRelaxations);
+  EXPECT_EQ(MyInteger::assignmentCount, 0);
+  EXPECT_EQ(index.distances(), expected);
+  EXPECT_EQ(lazy.distances(), expected);
+  EXPECT_EQ(forest.distances(), expected);
+  EXPECT_EQ(distances, expected);
+
+  // The point and bounded queries read the top of their queues without a
+  // copy too.  Theirs only go into the answer: none for a path, one per
+  // settled vertex for a region.
+  int target = static_cast<int>(std::max_element(expected.begin(),
+                                                 expected.end())
+                                - expected.begin());
+  DijkstraWorkspace<MyInteger> forward(N);
+  DijkstraWorkspace<MyInteger> backward(N);
+  ContractionHierarchy<MyInteger> hierarchy {G};
+  auto zero = [](int, int) { return MyInteger {0}; };
+  // the reverse graph is built once, on first use
+  G.reverse();
+  MyInteger::clearCounts();
+  auto bidirectional {shortestPath(G, 0, target, forward, backward)};
+  EXPECT_EQ(MyInteger::copyCount, 0);
+  EXPECT_EQ(bidirectional.length, expected.at(target));
+  MyInteger::clearCounts();
+  auto star {aStar(G, 0, target, zero, forward)};
+  EXPECT_EQ(MyInteger::copyCount, 0);
+  EXPECT_EQ(star.length, expected.at(target));
+  MyInteger::clearCounts();
+  auto query {hierarchy.query(0, target, forward, backward)};
+  EXPECT_EQ(MyInteger::copyCount, 0);
+  EXPECT_EQ(query.length, expected.at(target));
+  MyInteger radius {expected.at(target).value / 2};
+  MyInteger::clearCounts();
+  auto within {singleSourceIndexWithin(G, 0, radius, forward)};
+  int settled = static_cast<int>(within.vertices.size());
+  EXPECT_EQ(MyInteger::copyCount, settled);
+  // the queue's copy is assigned into its priority slot
+  int withinRelaxations = MyInteger::assignmentCount;
+  MyInteger::clearCounts();
+  auto lazyWithin {singleSourceLazyWithin(G, 0, radius, forward)};
+  // and one for the lazy queue per relaxation, as in singleSourceLazyTree
+  EXPECT_LE(MyInteger::copyCount, settled + withinRelaxations);
+  EXPECT_GT(within.vertices.size(), 1u);
+  EXPECT_LT(within.vertices.size(), static_cast<std::size_t>(N));
+  EXPECT_EQ(lazyWithin.vertices, within.vertices);
+}
+
+TEST(ShortestPathTreeTest, indexTreeMediumEWD) {
+  CompactGraph<int> G {"mediumEWD.txt"};
+  ShortestPathTree<int> tree {singleSourceIndexTree(G, 0)};
+  EXPECT_TRUE(isSubgraph(tree, G));
+  EXPECT_TRUE(isTreePlusIsolated(tree, 0));
+  auto bestDistanceTo {pathLengthsFromRoot(tree, 0)};
+  EXPECT_EQ(bestDistanceTo, tree.distances());
+  EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, 0));
+}
+
+TEST(ShortestPathTreeTest, lazyTreeMatchesGraph) {
+  Graph<double> G {"tinyEWD.txt"};
+  ShortestPathTree<double> tree {singleSourceLazyTree(G, 0)};
+  Graph<double> shortestPath {tree.toGraph()};
+  EXPECT_TRUE(isSubgraph(shortestPath, G));
+  EXPECT_TRUE(isSubgraph(G, shortestPath) == false);
+  EXPECT_EQ(pathLengthsFromRoot(shortestPath, 0), tree.distances());
+  EXPECT_EQ(pathLengthsFromRoot(singleSourceLazy(G, 0), 0), tree.distances());
+  EXPECT_EQ(tree.pathTo(3), (std::vector<int> {0, 2, 7, 3}));
+  EXPECT_DOUBLE_EQ(tree.distance(3), 99.0);
+  EXPECT_DOUBLE_EQ(tree.parentWeight(3), G.getEdgeWeight(7, 3));
+  EXPECT_EQ(tree.pathTo(0), (std::vector<int> {0}));
+}
+
+TEST(ShortestPathTreeTest, unreachedVertices) {
+  Graph<MyInteger> G {4};
+  G.addEdge(0, 1, MyInteger {3});
+  G.addEdge(2, 3, MyInteger {1});
+  ShortestPathTree<MyInteger> tree {singleSourceIndexTree(G, 0)};
+  EXPECT_TRUE(tree.reached(1));
+  EXPECT_FALSE(tree.reached(3));
+  EXPECT_EQ(tree.parent(3), -1);
+  EXPECT_EQ(tree.distance(3), infinity<MyInteger>());
+  EXPECT_TRUE(tree.pathTo(3).empty());
+  EXPECT_TRUE(isTreePlusIsolated(tree, 0));
+}
+
+// delta-stepping must find the same distances as Dijkstra for any bucket
+// width and number of threads
+template <typename T, template <typename> class GraphType>
+void deltaSteppingMatchesIndex(const GraphType<T>& G, int source,
+                               const std::vector<T>& deltas) {
+  ShortestPathTree<T> expected {singleSourceIndexTree(G, source)};
+  for (const T& delta : deltas) {
+    for (int numThreads : {1, 2, 3, 8}) {
+      ShortestPathTree<T> tree {singleSourceDeltaSteppingTree(G, source, delta,
+                                                              numThreads)};
+      EXPECT_TRUE(isSubgraph(tree, G));
+      EXPECT_TRUE(isTreePlusIsolated(tree, source));
+      auto bestDistanceTo {pathLengthsFromRoot(tree, source)};
+      EXPECT_EQ(bestDistanceTo, tree.distances());
+      EXPECT_EQ(bestDistanceTo, expected.distances());
+      EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, source));
+    }
+  }
+}
+
+TEST(DeltaSteppingTest, tinyEWD) {
+  Graph<double> G {"tinyEWD.txt"};
+  deltaSteppingMatchesIndex(G, 0, {1.0, 20.0, 50.0, 1000.0});
+}
+
+TEST(DeltaSteppingTest, mediumEWD) {
+  CompactGraph<int> G {"mediumEWD.txt"};
+  deltaSteppingMatchesIndex(G, 0, {1, defaultDelta(G), 5000});
+  deltaSteppingMatchesIndex(G, 137, {defaultDelta(G)});
+}
+
+TEST(DeltaSteppingTest, randomGraphs) {
+  deltaSteppingMatchesIndex(randomGraph(600, 77, 0.02), 5, {1, 3, 10});
+  deltaSteppingMatchesIndex(randomGraphDouble(300, 78, 0.05), 0, {0.1, 1.0});
+}
+
+TEST(DeltaSteppingTest, myIntegerAndUnreachable) {
+  // vertices 3 and 4 are not reached
+  Graph<MyInteger> G {5};
+  G.addEdge(0, 1, MyInteger {3});
+  G.addEdge(1, 2, MyInteger {0});
+  G.addEdge(0, 2, MyInteger {4});
+  deltaSteppingMatchesIndex(G, 0, {MyInteger {1}, MyInteger {2}});
+  ShortestPathTree<MyInteger> tree {
+      singleSourceDeltaSteppingTree(G, 0, MyInteger {1}, 4)};
+  EXPECT_FALSE(tree.reached(3));
+  EXPECT_EQ(tree.pathTo(2), (std::vector<int> {0, 1, 2}));
+}
+
+TEST(DeltaSteppingTest, badArguments) {
+  Graph<int> G {"tinyEWD.txt"};
+  EXPECT_THROW(singleSourceDeltaSteppingTree(G, 0, 0), std::invalid_argument);
+  EXPECT_THROW(singleSourceDeltaSteppingTree(G, 8, 5), std::out_of_range);
+}
+
+TEST(DeltaSteppingTest, singleSourceShortestPaths) {
+  Graph<int> G {"mediumEWD.txt"};
+  Graph<int> shortestPath {singleSourceShortestPaths(G, 0)};
+  EXPECT_TRUE(isSubgraph(shortestPath, G));
+  EXPECT_TRUE(isTreePlusIsolated(shortestPath, 0));
+  auto bestDistanceTo {pathLengthsFromRoot(shortestPath, 0)};
+  EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, 0));
+}
+
+// the NY road data is not kept in the repository
+TEST(DeltaSteppingTest, USAGraph) {
+  if (not std::filesystem::exists("USA-road-d.NY.gr")) {
+    GTEST_SKIP() << "USA-road-d.NY.gr not found";
+  }
+  CompactGraph<int> G {"USA-road-d.NY.gr"};
+  auto expected {singleSourceIndexTree(G, 0).distances()};
+  for (int numThreads : {1, defaultThreadCount()}) {
+    auto start = std::chrono::steady_clock::now();
+    ShortestPathTree<int> tree {
+        singleSourceDeltaSteppingTree(G, 0, defaultDelta(G), numThreads)};
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << numThreads << " threads: " << elapsed.count() << "s\n";
+    EXPECT_TRUE(isSubgraph(tree, G));
+    EXPECT_TRUE(isTreePlusIsolated(tree, 0));
+    EXPECT_EQ(tree.distances(), expected);
+    EXPECT_TRUE(allEdgesRelaxed(tree.distances(), G, 0));
+  }
+}
+
+// consecutive vertices of path must be joined by edges adding up to length
+template <typename T, template <typename> class GraphType>
+T pathWeight(const GraphType<T>& G, const std::vector<int>& path) {
+  T total {};
+  for (std::size_t i = 1; i < path.size(); ++i) {
+    total = total + G.getEdgeWeight(path[i - 1], path[i]);
+  }
+  return total;
+}
+
+template <typename T, template <typename> class GraphType>
+void bidirectionalMatchesIndex(const GraphType<T>& G, int numSources) {
+  DijkstraWorkspace<T> forward(G.size());
+  DijkstraWorkspace<T> backward(G.size());
+  for (int source = 0; source < numSources; ++source) {
+    ShortestPathTree<T> expected {singleSourceIndexTree(G, source)};
+    for (int target = 0; target < G.size(); target += 7) {
+      PathAndLength<T> answer {shortestPath(G, source, target, forward, backward)};
+      EXPECT_EQ(answer.length, expected.distance(target));
+      if (expected.reached(target)) {
+        ASSERT_FALSE(answer.path.empty());
+        EXPECT_EQ(answer.path.front(), source);
+        EXPECT_EQ(answer.path.back(), target);
+        EXPECT_EQ(pathWeight(G, answer.path), answer.length);
+      } else {
+        EXPECT_TRUE(answer.path.empty());
+      }
+    }
+  }
+}
+
+TEST(BidirectionalTest, tinyEWD) {
+  Graph<double> G {"tinyEWD.txt"};
+  PathAndLength<double> answer {shortestPath(G, 0, 3)};
+  EXPECT_DOUBLE_EQ(answer.length, 99.0);
+  EXPECT_EQ(answer.path, (std::vector<int> {0, 2, 7, 3}));
+  answer = shortestPath(G, 5, 5);
+  EXPECT_DOUBLE_EQ(answer.length, 0.0);
+  EXPECT_EQ(answer.path, (std::vector<int> {5}));
+  bidirectionalMatchesIndex(G, G.size());
+}
+
+TEST(BidirectionalTest, mediumEWD) {
+  bidirectionalMatchesIndex(CompactGraph<int> {"mediumEWD.txt"}, 5);
+  bidirectionalMatchesIndex(Graph<MyInteger> {"mediumEWD.txt"}, 2);
+}
+
+TEST(BidirectionalTest, randomGraphs) {
+  bidirectionalMatchesIndex(randomGraph(300, 12, 0.01), 10);
+  bidirectionalMatchesIndex(CompactGraph<double> {randomGraphDouble(200, 13, 0.02)}, 10);
+}
+
+TEST(BidirectionalTest, mappedGraph) {
+  std::string file {scratchFile("bidirectional.bin")};
+  writeBinaryGraph(Graph<int> {"mediumEWD.txt"}, file);
+  MappedGraph<int> G {file};
+  bidirectionalMatchesIndex(G, 2);
+  std::filesystem::remove(file);
+}
+
+TEST(BidirectionalTest, unreachable) {
+  Graph<int> G {4};
+  G.addEdge(0, 1, 2);
+  G.addEdge(2, 3, 1);
+  PathAndLength<int> answer {shortestPath(G, 0, 3)};
+  EXPECT_TRUE(answer.path.empty());
+  EXPECT_EQ(answer.length, infinity<int>());
+  EXPECT_THROW(shortestPath(G, 0, 4), std::out_of_range);
+}
+
+TEST(BidirectionalTest, reverseFollowsChanges) {
+  Graph<int> G {3};
+  G.addEdge(0, 1, 2);
+  EXPECT_TRUE(G.reverse().isEdge(1, 0));
+  EXPECT_FALSE(G.reverse().isEdge(2, 1));
+  G.addEdge(1, 2, 5);
+  EXPECT_TRUE(G.reverse().isEdge(2, 1));
+  EXPECT_EQ(shortestPath(G, 0, 2).length, 7);
+  G.removeEdge(0, 1);
+  EXPECT_FALSE(G.reverse().isEdge(1, 0));
+  EXPECT_EQ(shortestPath(G, 0, 2).length, infinity<int>());
+  CompactGraph<int> C {"tinyEWD.txt"};
+  EXPECT_EQ(C.reverse().numEdges(), C.numEdges());
+  EXPECT_EQ(C.reverse().getEdgeWeight(3, 7), C.getEdgeWeight(7, 3));
+  EXPECT_EQ(&C.reverse(), &C.reverse());
+}
+
+// width x height grid with edges both ways between neighbouring points.
+// Points are spacing apart and an edge weighs its length times a random
+// factor from 1 to 2, rounded up.  length(u, v) gives the length.
+template <typename Length>
+Graph<int> gridGraph(int width, int height, unsigned seed,
+                     const VertexCoordinates& coordinates, Length length) {
+  std::mt19937 mt {seed};
+  std::uniform_real_distribution<double> factor {1.0, 2.0};
+  Graph<int> G {width * height};
+  auto join = [&](int u, int v) {
+    int weight = static_cast<int>(std::ceil(length(coordinates, u, v) * factor(mt)));
+    G.addEdge(u, v, weight);
+    G.addEdge(v, u, weight);
+  };
+  for (int row = 0; row < height; ++row) {
+    for (int column = 0; column < width; ++column) {
+      int v = row * width + column;
+      if (column + 1 < width) {
+        join(v, v + 1);
+      }
+      if (row + 1 < height) {
+        join(v, v + width);
+      }
+    }
+  }
+  return G;
+}
+
+VertexCoordinates gridCoordinates(int width, int height, double originX,
+                                  double originY, double spacing) {
+  VertexCoordinates coordinates {};
+  for (int row = 0; row < height; ++row) {
+    for (int column = 0; column < width; ++column) {
+      coordinates.x.push_back(originX + column * spacing);
+      coordinates.y.push_back(originY + row * spacing);
+    }
+  }
+  return coordinates;
+}
+
+int settledCount(const DijkstraWorkspace<int>& workspace) {
+  const std::vector<int>& touched {workspace.touched()};
+  return static_cast<int>(std::count_if(touched.begin(), touched.end(),
+      [&](int v) { return workspace.settled(v); }));
+}
+
+template <typename Heuristic>
+void aStarMatchesDijkstra(const Graph<int>& G, const Heuristic& heuristic,
+                          int numQueries) {
+  std::mt19937 mt {99};
+  std::uniform_int_distribution<int> vertex {0, G.size() - 1};
+  DijkstraWorkspace<int> workspace(G.size());
+  DijkstraWorkspace<int> plain(G.size());
+  long long aStarSettled = 0;
+  long long dijkstraSettled = 0;
+  for (int query = 0; query < numQueries; ++query) {
+    int source = vertex(mt);
+    int target = vertex(mt);
+    PathAndLength<int> answer {aStar(G, source, target, heuristic, workspace)};
+    aStarSettled += settledCount(workspace);
+    singleSourceSearch(G, source, plain, target);
+    dijkstraSettled += settledCount(plain);
+    EXPECT_EQ(answer.length, plain.distance(target));
+    EXPECT_EQ(answer.path.front(), source);
+    EXPECT_EQ(answer.path.back(), target);
+    EXPECT_EQ(pathWeight(G, answer.path), answer.length);
+  }
+  // the heuristic has to save work, even against Dijkstra stopped early
+  EXPECT_LT(aStarSettled, dijkstraSettled);
+}
+
+TEST(AStarTest, readCoordinates) {
+  std::string file {scratchFile("tiny.co")};
+  {
+    std::ofstream out {file};
+    out << "c tiny coordinate file\n"
+        << "p aux sp co 3\n"
+        << "c graph contains 3 nodes\n"
+        << "v 1 -73530767 41085396\n"
+        << "v 3 -73519366 41048796\n"
+        << "v 2 -73530538 41086098\n";
+  }
+  VertexCoordinates coordinates {readCoordinates(file)};
+  ASSERT_EQ(coordinates.size(), 3);
+  EXPECT_DOUBLE_EQ(coordinates.x.at(0), -73530767);
+  EXPECT_DOUBLE_EQ(coordinates.y.at(1), 41086098);
+  EXPECT_DOUBLE_EQ(coordinates.x.at(2), -73519366);
+  // vertices 1 and 2 are about 80 metres apart
+  EXPECT_NEAR(greatCircleDistance(coordinates, 0, 1), 80.0, 2.0);
+  EXPECT_DOUBLE_EQ(greatCircleDistance(coordinates, 0, 1),
+                   greatCircleDistance(coordinates, 1, 0));
+  std::filesystem::remove(file);
+}
+
+TEST(AStarTest, euclideanGrid) {
+  VertexCoordinates coordinates {gridCoordinates(60, 60, 0, 0, 100)};
+  Graph<int> G {gridGraph(60, 60, 5, coordinates, euclideanDistance)};
+  auto heuristic {euclideanHeuristic(G, coordinates)};
+  EXPECT_NEAR(heuristic.scaleFactor(), 1.0, 0.05);
+  aStarMatchesDijkstra(G, heuristic, 40);
+}
+
+TEST(AStarTest, greatCircleGrid) {
+  // a grid of points around Manhattan, 0.001 degrees apart
+  VertexCoordinates coordinates {
+      gridCoordinates(50, 50, -74000000, 40700000, 1000)};
+  Graph<int> G {gridGraph(50, 50, 6, coordinates, greatCircleDistance)};
+  aStarMatchesDijkstra(G, greatCircleHeuristic(G, coordinates), 40);
+}
+
+TEST(AStarTest, zeroHeuristicIsDijkstra) {
+  Graph<double> G {"tinyEWD.txt"};
+  PathAndLength<double> answer {aStar(G, 0, 3, [](int, int) { return 0.0; })};
+  EXPECT_DOUBLE_EQ(answer.length, 99.0);
+  EXPECT_EQ(answer.path, (std::vector<int> {0, 2, 7, 3}));
+  Graph<int> H {3};
+  H.addEdge(0, 1, 4);
+  PathAndLength<int> unreachable {aStar(H, 0, 2, [](int, int) { return 0; })};
+  EXPECT_TRUE(unreachable.path.empty());
+  EXPECT_EQ(unreachable.length, infinity<int>());
+}
+
+TEST(AStarTest, wrongCoordinates) {
+  Graph<int> G {"tinyEWD.txt"};
+  VertexCoordinates coordinates {gridCoordinates(2, 2, 0, 0, 1)};
+  EXPECT_THROW(euclideanHeuristic(G, coordinates), std::invalid_argument);
+}
+
+// the NY road data is not kept in the repository
+TEST(AStarTest, USAGraph) {
+  if (not std::filesystem::exists("USA-road-d.NY.gr")
+      or not std::filesystem::exists("USA-road-d.NY.co")) {
+    GTEST_SKIP() << "USA-road-d.NY.gr or USA-road-d.NY.co not found";
+  }
+  Graph<int> G {"USA-road-d.NY.gr"};
+  VertexCoordinates coordinates {readCoordinates("USA-road-d.NY.co")};
+  auto heuristic {greatCircleHeuristic(G, coordinates)};
+  std::mt19937 mt {11};
+  std::uniform_int_distribution<int> vertex {0, G.size() - 1};
+  DijkstraWorkspace<int> workspace(G.size());
+  long long settled = 0;
+  const int numQueries = 20;
+  for (int query = 0; query < numQueries; ++query) {
+    int source = vertex(mt);
+    int target = vertex(mt);
+    PathAndLength<int> answer {aStar(G, source, target, heuristic, workspace)};
+    EXPECT_EQ(answer.length, singleSourceIndexTree(G, source).distance(target));
+    settled += settledCount(workspace);
+  }
+  // singleSourceIndex settles the whole graph on every query
+  EXPECT_LT(settled * 10, static_cast<long long>(G.size()) * numQueries);
+}
+
+// every query must give the Dijkstra distance and a path of that length
+template <typename T, template <typename> class GraphType>
+void hierarchyMatchesDijkstra(const ContractionHierarchy<T>& hierarchy,
+                              const GraphType<T>& G,
+                              const std::vector<int>& sources) {
+  DijkstraWorkspace<T> forward(G.size());
+  DijkstraWorkspace<T> backward(G.size());
+  for (int source : sources) {
+    Graph<T> shortestPath {singleSourceIndex(G, source)};
+    auto expected {pathLengthsFromRoot(shortestPath, source)};
+    std::vector<T> bestDistanceTo(G.size());
+    for (int target = 0; target < G.size(); ++target) {
+      PathAndLength<T> answer {hierarchy.query(source, target, forward, backward)};
+      bestDistanceTo.at(target) = answer.length;
+      if (!answer.path.empty()) {
+        EXPECT_EQ(answer.path.front(), source);
+        EXPECT_EQ(answer.path.back(), target);
+        EXPECT_EQ(pathWeight(G, answer.path), answer.length);
+      }
+    }
+    EXPECT_EQ(bestDistanceTo, expected);
+    EXPECT_TRUE(allEdgesRelaxed(bestDistanceTo, G, source));
+  }
+}
+
+TEST(ContractionHierarchyTest, tinyEWD) {
+  Graph<double> G {"tinyEWD.txt"};
+  ContractionHierarchy<double> hierarchy {G};
+  hierarchyMatchesDijkstra(hierarchy, G, {0, 1, 2, 3, 4, 5, 6, 7});
+  PathAndLength<double> answer {hierarchy.query(0, 3)};
+  EXPECT_DOUBLE_EQ(answer.length, 99.0);
+  EXPECT_EQ(answer.path, (std::vector<int> {0, 2, 7, 3}));
+}
+
+TEST(ContractionHierarchyTest, mediumEWD) {
+  CompactGraph<int> G {"mediumEWD.txt"};
+  for (int numThreads : {1, 4}) {
+    ContractionHierarchy<int> hierarchy {G, numThreads};
+    hierarchyMatchesDijkstra(hierarchy, G, {0, 42, 249});
+  }
+}
+
+TEST(ContractionHierarchyTest, myInteger) {
+  Graph<MyInteger> G {"mediumEWD.txt"};
+  ContractionHierarchy<MyInteger> hierarchy {G};
+  hierarchyMatchesDijkstra(hierarchy, G, {7});
+}
+
+TEST(ContractionHierarchyTest, randomGraphs) {
+  Graph<int> G {randomGraph(120, 40, 0.05)};
+  hierarchyMatchesDijkstra(ContractionHierarchy<int> {G, 3}, G, {0, 60});
+  VertexCoordinates coordinates {gridCoordinates(30, 30, 0, 0, 10)};
+  Graph<int> grid {gridGraph(30, 30, 41, coordinates, euclideanDistance)};
+  ContractionHierarchy<int> hierarchy {grid, 3};
+  hierarchyMatchesDijkstra(hierarchy, grid, {0, 465, 899});
+  // a hierarchy search sees far less than the whole grid
+  DijkstraWorkspace<int> forward(grid.size());
+  DijkstraWorkspace<int> backward(grid.size());
+  hierarchy.query(0, 899, forward, backward);
+  EXPECT_LT(forward.touched().size() + backward.touched().size(),
+            static_cast<std::size_t>(grid.size()) / 2);
+}
+
+TEST(ContractionHierarchyTest, saveAndLoad) {
+  Graph<int> G {"mediumEWD.txt"};
+  ContractionHierarchy<int> hierarchy {G};
+  std::string file {scratchFile("mediumEWD.ch")};
+  hierarchy.save(file);
+  ContractionHierarchy<int> loaded {file};
+  EXPECT_EQ(loaded.size(), hierarchy.size());
+  EXPECT_EQ(loaded.numShortcuts(), hierarchy.numShortcuts());
+  EXPECT_EQ(loaded.rank(17), hierarchy.rank(17));
+  hierarchyMatchesDijkstra(loaded, G, {3});
+  EXPECT_THROW(ContractionHierarchy<double> {file}, std::runtime_error);
+  // flip a byte in the body
+  {
+    std::fstream bytes {file, std::ios::in | std::ios::out | std::ios::binary};
+    bytes.seekp(100);
+    bytes.put('\x7f');
+  }
+  EXPECT_THROW(ContractionHierarchy<int> {file}, std::runtime_error);
+  std::filesystem::remove(file);
+  EXPECT_THROW(ContractionHierarchy<int> {file}, std::runtime_error);
+}
+
+// the NY road data is not kept in the repository
+TEST(ContractionHierarchyTest, USAGraph) {
+  if (not std::filesystem::exists("USA-road-d.NY.gr")) {
+    GTEST_SKIP() << "USA-road-d.NY.gr not found";
+  }
+  CompactGraph<int> G {"USA-road-d.NY.gr"};
+  ContractionHierarchy<int> hierarchy {G};
+  std::mt19937 mt {21};
+  std::uniform_int_distribution<int> vertex {0, G.size() - 1};
+  DijkstraWorkspace<int> forward(G.size());
+  DijkstraWorkspace<int> backward(G.size());
+  for (int query = 0; query < 10; ++query) {
+    int source = vertex(mt);
+    auto expected {singleSourceIndexTree(G, source).distances()};
+    for (int i = 0; i < 100; ++i) {
+      int target = vertex(mt);
+      EXPECT_EQ(hierarchy.query(source, target, forward, backward).length,
+                expected.at(target));
+    }
+  }
+}
+
+// the bounds must be lower bounds and consistent, h(u) <= w(u, v) + h(v),
+// on the edges that can still lead to the target
+template <typename T, template <typename> class GraphType>
+void landmarkBoundsHold(const LandmarkTables<T>& tables, const GraphType<T>& G,
+                        const std::vector<int>& targets) {
+  for (int target : targets) {
+    auto toTarget {singleSourceIndexTree(G.reverse(), target)};
+    for (int v = 0; v < G.size(); ++v) {
+      if (toTarget.reached(v)) {
+        EXPECT_LE(tables(v, target), toTarget.distance(v));
+        for (const auto& [neighbour, weight] : *(G.neighbours(v))) {
+          if (toTarget.reached(neighbour)) {
+            EXPECT_LE(tables(v, target), weight + tables(neighbour, target));
+          }
+        }
+      }
+    }
+    EXPECT_EQ(tables(target, target), T {});
+  }
+}
+
+TEST(LandmarkTest, tinyEWD) {
+  Graph<double> G {"tinyEWD.txt"};
+  LandmarkTables<double> tables {G, 2};
+  EXPECT_EQ(tables.size(), 8);
+  ASSERT_EQ(tables.numLandmarks(), 2);
+  EXPECT_NE(tables.landmarks().at(0), tables.landmarks().at(1));
+  // the table rows are the distances from and to each landmark
+  int landmark = tables.landmarks().at(0);
+  auto from {singleSourceIndexTree(G, landmark)};
+  auto to {singleSourceIndexTree(G.reverse(), landmark)};
+  for (int v = 0; v < G.size(); ++v) {
+    EXPECT_EQ(tables.distanceFrom(0, v), from.distance(v));
+    EXPECT_EQ(tables.distanceTo(0, v), to.distance(v));
+  }
+  landmarkBoundsHold(tables, G, {0, 3, 6});
+  PathAndLength<double> answer {aStar(G, 0, 3, tables)};
+  EXPECT_DOUBLE_EQ(answer.length, 99.0);
+  EXPECT_EQ(answer.path, (std::vector<int> {0, 2, 7, 3}));
+}
+
+TEST(LandmarkTest, grid) {
+  VertexCoordinates coordinates {gridCoordinates(60, 60, 0, 0, 100)};
+  Graph<int> G {gridGraph(60, 60, 8, coordinates, euclideanDistance)};
+  LandmarkTables<int> tables {G, 8};
+  // farthest selection starts out in the corners
+  std::vector<int> corners {0, 59, 3540, 3599};
+  EXPECT_NE(std::find(corners.begin(), corners.end(), tables.landmarks().at(0)),
+            corners.end());
+  landmarkBoundsHold(tables, G, {0, 1234, 3599});
+  aStarMatchesDijkstra(G, tables, 40);
+}
+
+TEST(LandmarkTest, givenLandmarksAndThreads) {
+  CompactGraph<int> G {"mediumEWD.txt"};
+  LandmarkTables<int> one {G, std::vector<int> {3, 77, 140, 201}, 1};
+  LandmarkTables<int> four {G, std::vector<int> {3, 77, 140, 201}, 4};
+  EXPECT_EQ(four.landmarks(), (std::vector<int> {3, 77, 140, 201}));
+  for (int v = 0; v < G.size(); ++v) {
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(one.distanceFrom(i, v), four.distanceFrom(i, v));
+      EXPECT_EQ(one.distanceTo(i, v), four.distanceTo(i, v));
+    }
+  }
+  landmarkBoundsHold(four, G, {0, 100, 249});
+}
+
+TEST(LandmarkTest, unreachableAndMyInteger) {
+  Graph<int> G {randomGraph(200, 30, 0.01)};
+  LandmarkTables<int> tables {G, 6, 2};
+  landmarkBoundsHold(tables, G, {0, 50, 199});
+  DijkstraWorkspace<int> workspace(G.size());
+  for (int target = 0; target < G.size(); target += 7) {
+    EXPECT_EQ(aStar(G, 5, target, tables, workspace).length,
+              singleSourceIndexTree(G, 5).distance(target));
+  }
+  Graph<MyInteger> H {"mediumEWD.txt"};
+  LandmarkTables<MyInteger> myTables {H, 4, 4};
+  auto expected {singleSourceIndexTree(H, 9)};
+  for (int target : {0, 100, 249}) {
+    EXPECT_EQ(aStar(H, 9, target, myTables).length, expected.distance(target));
+  }
+}
+
+TEST(LandmarkTest, badArguments) {
+  Graph<int> G {"tinyEWD.txt"};
+  EXPECT_THROW((LandmarkTables<int> {G, 0}), std::invalid_argument);
+  EXPECT_THROW((LandmarkTables<int> {G, 9}), std::invalid_argument);
+  EXPECT_THROW((LandmarkTables<int> {G, std::vector<int> {}}), std::invalid_argument);
+  EXPECT_THROW((LandmarkTables<int> {G, std::vector<int> {1, 8}}), std::out_of_range);
+}
+
+TEST(LandmarkTest, saveAndLoad) {
+  Graph<int> G {"mediumEWD.txt"};
+  LandmarkTables<int> tables {G, 4};
+  std::string file {landmarkTablesFile(scratchFile("mediumEWD.txt"))};
+  tables.save(file);
+  LandmarkTables<int> loaded {file};
+  EXPECT_EQ(loaded.size(), tables.size());
+  EXPECT_EQ(loaded.landmarks(), tables.landmarks());
+  for (int v = 0; v < G.size(); ++v) {
+    EXPECT_EQ(loaded(v, 11), tables(v, 11));
+  }
+  EXPECT_THROW(LandmarkTables<double> {file}, std::runtime_error);
+  // flip a byte in the body
+  {
+    std::fstream bytes {file, std::ios::in | std::ios::out | std::ios::binary};
+    bytes.seekp(100);
+    bytes.put('\x7f');
+  }
+  EXPECT_THROW(LandmarkTables<int> {file}, std::runtime_error);
+  std::filesystem::remove(file);
+  EXPECT_THROW(LandmarkTables<int> {file}, std::runtime_error);
+}
+
+// the NY road data is not kept in the repository
+TEST(LandmarkTest, USAGraph) {
+  if (not std::filesystem::exists("USA-road-d.NY.gr")) {
+    GTEST_SKIP() << "USA-road-d.NY.gr not found";
+  }
+  CompactGraph<int> G {"USA-road-d.NY.gr"};
+  LandmarkTables<int> tables {G, 16};
+  std::mt19937 mt {31};
+  std::uniform_int_distribution<int> vertex {0, G.size() - 1};
+  DijkstraWorkspace<int> workspace(G.size());
+  for (int query = 0; query < 20; ++query) {
+    int source = vertex(mt);
+    int target = vertex(mt);
+    EXPECT_EQ(aStar(G, source, target, tables, workspace).length,
+              singleSourceIndexTree(G, source).distance(target));
+  }
+}
+
+template <typename T, template <typename> class GraphType>
+void matrixMatchesDijkstra(const DistanceMatrix<T>& matrix, const GraphType<T>& G,
+                           const std::vector<int>& sources,
+                           const std::vector<int>& targets) {
+  ASSERT_EQ(matrix.numRows(), static_cast<int>(sources.size()));
+  ASSERT_EQ(matrix.numColumns(), static_cast<int>(targets.size()));
+  for (int i = 0; i < matrix.numRows(); ++i) {
+    auto tree {singleSourceIndexTree(G, sources.at(i))};
+    for (int j = 0; j < matrix.numColumns(); ++j) {
+      EXPECT_EQ(matrix.at(i, j), tree.distance(targets.at(j)));
+    }
+  }
+}
+
+TEST(DistanceMatrixTest, tinyEWD) {
+  Graph<double> G {"tinyEWD.txt"};
+  DistanceMatrix<double> matrix {distanceMatrix(G, {0, 7}, {3, 0, 6})};
+  EXPECT_DOUBLE_EQ(matrix.at(0, 0), 99.0);
+  EXPECT_DOUBLE_EQ(matrix.at(0, 1), 0.0);
+  EXPECT_DOUBLE_EQ(matrix.row(1)[0], 39.0);
+  matrixMatchesDijkstra(matrix, G, {0, 7}, {3, 0, 6});
+  EXPECT_THROW(matrix.at(2, 0), std::out_of_range);
+  EXPECT_THROW(distanceMatrix(G, {0}, {8}), std::out_of_range);
+  EXPECT_THROW(distanceMatrix(G, {-1}, {0}), std::out_of_range);
+}
+
+TEST(DistanceMatrixTest, mediumEWDThreads) {
+  CompactGraph<int> G {"mediumEWD.txt"};
+  std::vector<int> sources {};
+  std::vector<int> targets {};
+  for (int v = 0; v < G.size(); v += 5) {
+    sources.push_back(v);
+    targets.push_back(G.size() - 1 - v);
+  }
+  // a target twice
+  targets.push_back(targets.front());
+  DistanceMatrix<int> one {distanceMatrix(G, sources, targets, 1)};
+  matrixMatchesDijkstra(one, G, sources, targets);
+  DistanceMatrix<int> four {distanceMatrix(G, sources, targets, 4)};
+  EXPECT_EQ(four.data(), one.data());
+}
+
+TEST(DistanceMatrixTest, unreachableAndEmpty) {
+  Graph<int> G {randomGraph(150, 20, 0.01)};
+  std::vector<int> all(G.size());
+  std::iota(all.begin(), all.end(), 0);
+  DistanceMatrix<int> matrix {distanceMatrix(G, {0, 1, 2, 3}, all, 2)};
+  matrixMatchesDijkstra(matrix, G, {0, 1, 2, 3}, all);
+  DistanceMatrix<int> noTargets {distanceMatrix(G, {0, 1}, {})};
+  EXPECT_EQ(noTargets.numRows(), 2);
+  EXPECT_TRUE(noTargets.data().empty());
+  DistanceMatrix<int> noSources {distanceMatrix(G, {}, {0, 1})};
+  EXPECT_EQ(noSources.numRows(), 0);
+  Graph<MyInteger> H {"mediumEWD.txt"};
+  matrixMatchesDijkstra(distanceMatrix(H, {4, 40}, {0, 200}), H, {4, 40}, {0, 200});
+}
+
+TEST(DistanceMatrixTest, writeInBlocks) {
+  Graph<int> G {"mediumEWD.txt"};
+  std::vector<int> sources {};
+  for (int v = 0; v < 50; ++v) {
+    sources.push_back(v * 3);
+  }
+  std::vector<int> targets {249, 0, 17, 120};
+  std::string file {scratchFile("mediumEWD.matrix")};
+  writeDistanceMatrix(G, sources, targets, file, 3, 7);
+  DistanceMatrix<int> loaded {file};
+  EXPECT_EQ(loaded.data(), distanceMatrix(G, sources, targets, 1).data());
+  loaded.save(file);
+  EXPECT_EQ(DistanceMatrix<int> {file}.data(), loaded.data());
+  EXPECT_THROW(DistanceMatrix<double> {file}, std::runtime_error);
+  // flip a byte in the body
+  {
+    std::fstream bytes {file, std::ios::in | std::ios::out | std::ios::binary};
+    bytes.seekp(100);
+    bytes.put('\x7f');
+  }
+  EXPECT_THROW(DistanceMatrix<int> {file}, std::runtime_error);
+  std::filesystem::remove(file);
+  EXPECT_THROW(DistanceMatrix<int> {file}, std::runtime_error);
+  EXPECT_THROW(writeDistanceMatrix(G, sources, targets, file, 1, 0),
+               std::invalid_argument);
+}
+
+TEST(QueryExecutorTest, answersMatchDijkstra) {
+  CompactGraph<int> G {"mediumEWD.txt"};
+  std::mt19937 mt {5};
+  std::uniform_int_distribution<int> vertex {0, G.size() - 1};
+  std::vector<DistanceQuery<int> > queries {};
+  for (int i = 0; i < 200; ++i) {
+    DistanceQuery<int> query {vertex(mt), vertex(mt)};
+    if (i % 3 == 1) {
+      query.radius = 20000;
+    } else if (i % 3 == 2) {
+      query.target = -1;
+      query.radius = 15000;
+    }
+    queries.push_back(query);
+  }
+  for (int numThreads : {1, 4}) {
+    QueryExecutor<int, CompactGraph> executor {G, numThreads};
+    EXPECT_EQ(executor.numThreads(), numThreads);
+    BatchResult<int> result {executor.run(queries)};
+    ASSERT_EQ(result.answers.size(), queries.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+      const DistanceQuery<int>& query {queries.at(i)};
+      auto tree {singleSourceIndexTree(G, query.source)};
+      int expected {query.target == -1 ? infinity<int>() : tree.distance(query.target)};
+      if (query.radius and *query.radius < expected) {
+        expected = infinity<int>();
+      }
+      EXPECT_EQ(result.answers.at(i).distance, expected);
+      if (query.target == -1) {
+        const std::vector<int>& distances {tree.distances()};
+        EXPECT_EQ(result.answers.at(i).settled,
+                  std::count_if(distances.begin(), distances.end(),
+                                [&](int d) { return d <= *query.radius; }));
+      }
+    }
+    const LatencyReport& latency {result.latency};
+    EXPECT_EQ(latency.count, 200);
+    EXPECT_LE(latency.p50, latency.p90);
+    EXPECT_LE(latency.p90, latency.p99);
+    EXPECT_LE(latency.p99, latency.max);
+    EXPECT_GT(latency.throughput, 0);
+  }
+}
+
+TEST(QueryExecutorTest, unevenBatchesAndReuse) {
+  Graph<int> G {randomGraph(300, 50, 0.02)};
+  QueryExecutor<int, Graph> executor {G, 3};
+  // the first share holds all the whole-graph searches, the others are
+  // stolen from it
+  std::vector<DistanceQuery<int> > queries {};
+  for (int i = 0; i < 30; ++i) {
+    queries.push_back({i, -1});
+  }
+  for (int i = 0; i < 60; ++i) {
+    queries.push_back({i, i, 0});
+  }
+  for (int repeat = 0; repeat < 3; ++repeat) {
+    BatchResult<int> result {executor.run(queries)};
+    for (int i = 0; i < 30; ++i) {
+      std::vector<int> distances {singleSourceIndexTree(G, i).distances()};
+      EXPECT_EQ(result.answers.at(i).settled,
+                std::count_if(distances.begin(), distances.end(),
+                              [](int d) { return d != infinity<int>(); }));
+    }
+    for (int i = 30; i < 90; ++i) {
+      EXPECT_EQ(result.answers.at(i).distance, 0);
+      EXPECT_EQ(result.answers.at(i).settled, 1);
+    }
+  }
+  EXPECT_EQ(executor.run({}).latency.count, 0);
+  EXPECT_THROW(executor.run({{0, 300}}), std::out_of_range);
+  EXPECT_THROW(executor.run({{-1, -1}}), std::out_of_range);
+}
+
+TEST(QueryExecutorTest, myIntegerAndPercentiles) {
+  Graph<MyInteger> G {"mediumEWD.txt"};
+  QueryExecutor<MyInteger, Graph> executor {G, 4};
+  EXPECT_EQ(executor.numThreads(), 1);
+  BatchResult<MyInteger> result {executor.run({{0, 249}})};
+  EXPECT_EQ(result.answers.at(0).distance,
+            singleSourceIndexTree(G, 0).distance(249));
+  std::vector<double> sorted {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  EXPECT_DOUBLE_EQ(percentile(sorted, 50), 5);
+  EXPECT_DOUBLE_EQ(percentile(sorted, 90), 9);
+  EXPECT_DOUBLE_EQ(percentile(sorted, 99), 10);
+  EXPECT_DOUBLE_EQ(percentile({}, 50), 0);
+}
+
+// region must be in order of distance, with Dijkstra's distances and a
+// shortest path tree edge to every vertex but the source
+template <typename T, template <typename> class GraphType>
+void regionIsConsistent(const SettledRegion<T>& region, const GraphType<T>& G,
+                        int source) {
+  auto tree {singleSourceIndexTree(G, source)};
+  ASSERT_GT(region.size(), 0);
+  EXPECT_EQ(region.vertices.front(), source);
+  EXPECT_EQ(region.parents.front(), -1);
+  std::vector<int> position(G.size(), -1);
+  for (int i = 0; i < region.size(); ++i) {
+    int v = region.vertices.at(i);
+    EXPECT_EQ(position.at(v), -1);
+    position.at(v) = i;
+    EXPECT_EQ(region.distances.at(i), tree.distance(v));
+    if (i > 0) {
+      EXPECT_LE(region.distances.at(i - 1), region.distances.at(i));
+      int parent = region.parents.at(i);
+      ASSERT_NE(parent, -1);
+      // parents are settled first
+      ASSERT_NE(position.at(parent), -1);
+      EXPECT_EQ(region.distances.at(position.at(parent)) + G.getEdgeWeight(parent, v),
+                region.distances.at(i));
+    }
+  }
+}
+
+TEST(BoundedDijkstraTest, withinRadius) {
+  Graph<int> G {"mediumEWD.txt"};
+  auto tree {singleSourceIndexTree(G, 10)};
+  DijkstraWorkspace<int> workspace(G.size());
+  for (int radius : {0, 5000, 20000, 1000000}) {
+    SettledRegion<int> index {singleSourceIndexWithin(G, 10, radius, workspace)};
+    regionIsConsistent(index, G, 10);
+    const std::vector<int>& distances {tree.distances()};
+    EXPECT_EQ(index.size(), std::count_if(distances.begin(), distances.end(),
+                                          [&](int d) { return d <= radius; }));
+    SettledRegion<int> lazy {singleSourceLazyWithin(G, 10, radius)};
+    EXPECT_EQ(lazy.distances, index.distances);
+    std::vector<int> indexVertices {index.vertices};
+    std::vector<int> lazyVertices {lazy.vertices};
+    std::sort(indexVertices.begin(), indexVertices.end());
+    std::sort(lazyVertices.begin(), lazyVertices.end());
+    EXPECT_EQ(lazyVertices, indexVertices);
+  }
+}
+
+TEST(BoundedDijkstraTest, untilTargets) {
+  Graph<int> G {"mediumEWD.txt"};
+  auto tree {singleSourceIndexTree(G, 0)};
+  std::vector<int> targets {3, 7, 3, 12};
+  SettledRegion<int> index {singleSourceIndexUntil(G, 0, targets)};
+  regionIsConsistent(index, G, 0);
+  SettledRegion<int> lazy {singleSourceLazyUntil(G, 0, targets)};
+  regionIsConsistent(lazy, G, 0);
+  for (const SettledRegion<int>& region : {index, lazy}) {
+    // the last vertex settled is the farthest target
+    int last = region.vertices.back();
+    EXPECT_TRUE(last == 3 or last == 7 or last == 12);
+    for (int target : targets) {
+      EXPECT_LE(tree.distance(target), tree.distance(last));
+    }
+    EXPECT_LT(region.size(), G.size());
+  }
+  EXPECT_EQ(singleSourceIndexUntil(G, 5, {}).vertices, std::vector<int> {5});
+  EXPECT_EQ(singleSourceLazyUntil(G, 5, {5}).vertices, std::vector<int> {5});
+}
+
+TEST(BoundedDijkstraTest, unreachableAndErrors) {
+  Graph<int> G {4};
+  G.addEdge(0, 1, 2);
+  G.addEdge(1, 2, 2);
+  SettledRegion<int> region {singleSourceIndexUntil(G, 0, {3, 1})};
+  EXPECT_EQ(region.vertices, (std::vector<int> {0, 1, 2}));
+  EXPECT_EQ(region.distances, (std::vector<int> {0, 2, 4}));
+  EXPECT_EQ(region.parents, (std::vector<int> {-1, 0, 1}));
+  EXPECT_EQ(singleSourceLazyUntil(G, 0, {3}).size(), 3);
+  EXPECT_EQ(singleSourceLazyWithin(G, 0, 3).size(), 2);
+  EXPECT_THROW(singleSourceIndexWithin(G, 4, 1), std::out_of_range);
+  EXPECT_THROW(singleSourceLazyUntil(G, 0, {4}), std::out_of_range);
+  Graph<MyInteger> H {"tinyEWD.txt"};
+  regionIsConsistent(singleSourceIndexWithin(H, 0, MyInteger {50}), H, 0);
+}
+
+// distances of the k nearest POIs the slow way, from a full tree
+std::vector<int> nearestBySorting(const Graph<int>& G, int source,
+                                  const std::vector<int>& pois, int k) {
+  auto tree {singleSourceIndexTree(G, source)};
+  std::vector<int> distances {};
+  for (int poi : pois) {
+    if (tree.reached(poi)) {
+      distances.push_back(tree.distance(poi));
+    }
+  }
+  std::sort(distances.begin(), distances.end());
+  distances.resize(std::min<std::size_t>(k, distances.size()));
+  return distances;
+}
+
+TEST(KNearestTest, bitmapAndSortedAgree) {
+  Graph<int> G {randomGraph(400, 50, 0.01)};
+  std::mt19937 mt {3};
+  std::bernoulli_distribution tagged {0.05};
+  std::vector<bool> bitmap(G.size());
+  std::vector<int> sorted {};
+  for (int v = 0; v < G.size(); ++v) {
+    if (tagged(mt)) {
+      bitmap.at(v) = true;
+      sorted.push_back(v);
+    }
+  }
+  DijkstraWorkspace<int> workspace(G.size());
+  for (int source : {0, 17, 399}) {
+    for (int k : {1, 5, 1000}) {
+      std::vector<NearbyVertex<int> > fromBitmap {
+          kNearest(G, source, bitmap, k, workspace)};
+      std::vector<NearbyVertex<int> > fromSorted {kNearest(G, source, sorted, k)};
+      std::vector<int> expected {nearestBySorting(G, source, sorted, k)};
+      ASSERT_EQ(fromBitmap.size(), expected.size());
+      ASSERT_EQ(fromSorted.size(), expected.size());
+      for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(fromBitmap.at(i).distance, expected.at(i));
+        EXPECT_EQ(fromSorted.at(i).vertex, fromBitmap.at(i).vertex);
+        EXPECT_TRUE(bitmap.at(fromBitmap.at(i).vertex));
+      }
+    }
+  }
+}
+
+TEST(KNearestTest, stopsEarly) {
+  Graph<int> G {"mediumEWD.txt"};
+  std::vector<int> pois {};
+  for (int v = 0; v < G.size(); v += 10) {
+    pois.push_back(v);
+  }
+  DijkstraWorkspace<int> workspace(G.size());
+  std::vector<NearbyVertex<int> > nearest {kNearest(G, 0, pois, 3, workspace)};
+  ASSERT_EQ(nearest.size(), 3u);
+  // the source is a POI at distance 0
+  EXPECT_EQ(nearest.at(0).vertex, 0);
+  EXPECT_EQ(nearest.at(0).distance, 0);
+  EXPECT_LT(workspace.touched().size(), static_cast<std::size_t>(G.size()) / 2);
+  EXPECT_TRUE(kNearest(G, 0, pois, 0).empty());
+}
+
+TEST(KNearestTest, batch) {
+  CompactGraph<int> G {"mediumEWD.txt"};
+  std::vector<int> pois {5, 50, 100, 150, 200};
+  std::vector<int> sources {0, 1, 2, 3, 4, 249, 248};
+  auto one {kNearestBatch(G, sources, pois, 2, 1)};
+  auto three {kNearestBatch(G, sources, pois, 2, 3)};
+  ASSERT_EQ(one.size(), sources.size());
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    std::vector<NearbyVertex<int> > single {kNearest(G, sources.at(i), pois, 2)};
+    ASSERT_EQ(one.at(i).size(), 2u);
+    ASSERT_EQ(three.at(i).size(), 2u);
+    for (int j = 0; j < 2; ++j) {
+      EXPECT_EQ(one.at(i).at(j).vertex, single.at(j).vertex);
+      EXPECT_EQ(three.at(i).at(j).distance, single.at(j).distance);
+    }
+  }
+  Graph<MyInteger> H {"mediumEWD.txt"};
+  EXPECT_EQ(kNearestBatch(H, {0}, pois, 1).at(0).at(0).distance,
+            singleSourceIndexTree(H, 0).distance(kNearest(H, 0, pois, 1).at(0).vertex));
+}
+
+TEST(KNearestTest, badPoiSets) {
+  Graph<int> G {"tinyEWD.txt"};
+  std::vector<int> unsorted {3, 1};
+  std::vector<int> outside {1, 8};
+  std::vector<bool> wrongSize(5);
+  std::vector<int> fine {1, 3};
+  EXPECT_THROW(kNearest(G, 0, unsorted, 1), std::invalid_argument);
+  EXPECT_THROW(kNearest(G, 0, outside, 1), std::out_of_range);
+  EXPECT_THROW(kNearest(G, 0, wrongSize, 1), std::invalid_argument);
+  EXPECT_THROW(kNearest(G, 8, fine, 1), std::out_of_range);
+  EXPECT_THROW(kNearest(G, 0, fine, -1), std::invalid_argument);
+  EXPECT_THROW(kNearestBatch(G, {0, 9}, fine, 1), std::out_of_range);
+}
+
+template <typename T>
+void dynamicMatchesDijkstra(const DynamicShortestPaths<T>& paths,
+                            const Graph<T>& G) {
+  auto expected {singleSourceIndexTree(G, paths.source())};
+  EXPECT_EQ(paths.tree().distances(), expected.distances());
+  for (int v = 0; v < G.size(); ++v) {
+    if (paths.reached(v) and v != paths.source()) {
+      int parent = paths.parent(v);
+      ASSERT_TRUE(G.isEdge(parent, v));
+      EXPECT_EQ(paths.distance(parent) + G.getEdgeWeight(parent, v),
+                paths.distance(v));
+    }
+  }
+}
+
+TEST(DynamicShortestPathsTest, randomBatches) {
+  Graph<int> G {randomGraph(200, 40, 0.03)};
+  DynamicShortestPaths<int> paths {G, 0};
+  dynamicMatchesDijkstra(paths, G);
+  std::mt19937 mt {17};
+  std::uniform_int_distribution<int> vertex {0, G.size() - 1};
+  std::uniform_int_distribution<int> weight {1, 40};
+  std::uniform_int_distribution<int> kind {0, 2};
+  for (int round = 0; round < 30; ++round) {
+    std::vector<EdgeUpdate<int> > batch {};
+    for (int i = 0; i < 8; ++i) {
+      int from = vertex(mt);
+      // change an edge that is there, mostly one on a shortest path
+      const auto& edges {*(G.neighbours(from))};
+      int to = edges.empty() ? vertex(mt) : edges.begin()->first;
+      switch (kind(mt)) {
+        case 0:
+          batch.push_back({from, to, std::nullopt});
+          break;
+        case 1:
+          batch.push_back({from, to, weight(mt)});
+          break;
+        default:
+          batch.push_back({from, vertex(mt), weight(mt)});
+      }
+    }
+    paths.update(batch);
+    dynamicMatchesDijkstra(paths, G);
+  }
+}
+
+TEST(DynamicShortestPathsTest, repairsLocally) {
+  VertexCoordinates coordinates {gridCoordinates(40, 40, 0, 0, 10)};
+  Graph<int> G {gridGraph(40, 40, 23, coordinates, euclideanDistance)};
+  DynamicShortestPaths<int> paths {G, 0};
+  EXPECT_EQ(paths.lastRepairSize(), G.size());
+  // the tree edge into the far corner gets heavier
+  int corner = G.size() - 1;
+  int parent = paths.parent(corner);
+  paths.setEdge(parent, corner, G.getEdgeWeight(parent, corner) + 5);
+  dynamicMatchesDijkstra(paths, G);
+  EXPECT_LT(paths.lastRepairSize(), 10);
+  // a short cut from the source towards the middle
+  paths.setEdge(0, 820, 1);
+  dynamicMatchesDijkstra(paths, G);
+  EXPECT_EQ(paths.distance(820), 1);
+  EXPECT_EQ(paths.pathTo(820), (std::vector<int> {0, 820}));
+  paths.removeEdge(0, 820);
+  dynamicMatchesDijkstra(paths, G);
+  EXPECT_FALSE(G.isEdge(0, 820));
+}
+
+TEST(DynamicShortestPathsTest, disconnectAndErrors) {
+  Graph<double> G {"tinyEWD.txt"};
+  DynamicShortestPaths<double> paths {G, 0};
+  EXPECT_DOUBLE_EQ(paths.distance(3), 99.0);
+  // 0 -> 2 and 0 -> 4 are the only ways out of 0
+  paths.update({{0, 2, std::nullopt}, {0, 4, std::nullopt}});
+  for (int v = 1; v < G.size(); ++v) {
+    EXPECT_FALSE(paths.reached(v));
+    EXPECT_TRUE(paths.pathTo(v).empty());
+  }
+  paths.update({{0, 2, 26.0}});
+  dynamicMatchesDijkstra(paths, G);
+  EXPECT_TRUE(paths.reached(3));
+  EXPECT_THROW(paths.setEdge(0, 8, 1.0), std::out_of_range);
+  EXPECT_THROW(paths.setEdge(0, 1, -1.0), std::invalid_argument);
+  EXPECT_THROW((DynamicShortestPaths<double> {G, 8}), std::out_of_range);
+}
+
+// the certificate must be a cycle of edges in G with negative weight
+template <typename T>
+void isNegativeCycle(const std::vector<int>& cycle, const Graph<T>& G) {
+  ASSERT_FALSE(cycle.empty());
+  T weight {};
+  for (std::size_t i = 0; i < cycle.size(); ++i) {
+    int from = cycle.at(i);
+    int to = cycle.at((i + 1) % cycle.size());
+    ASSERT_TRUE(G.isEdge(from, to));
+    weight = weight + G.getEdgeWeight(from, to);
+  }
+  EXPECT_LT(weight, T {});
+}
+
+// random weights that can be negative but leave no negative cycle:
+// w(u, v) + potential(u) - potential(v) for positive w.  Distances are
+// then Dijkstra's distances shifted by the potentials
+Graph<int> reweighted(const Graph<int>& G, const std::vector<int>& potential) {
+  Graph<int> H {G.size()};
+  for (int u = 0; u < G.size(); ++u) {
+    for (const auto& [v, weight] : *(G.neighbours(u))) {
+      H.addEdge(u, v, weight + potential.at(u) - potential.at(v));
+    }
+  }
+  return H;
+}
+
+TEST(BellmanFordTest, dijkstraFail) {
+  Graph<int> G(5);
+  G.addEdge(0, 1, 4);
+  G.addEdge(1, 2, -2);
+  G.addEdge(2, 3, -2);
+  G.addEdge(3, 4, 1);
+  G.addEdge(0, 3, 2);
+  std::vector<int> expected {0, 4, 2, 0, 1};
+  for (const auto& result : {spfa(G, 0), bellmanFord(G, 0, 1), bellmanFord(G, 0, 3)}) {
+    EXPECT_FALSE(result.hasNegativeCycle());
+    EXPECT_EQ(result.tree.distances(), expected);
+    EXPECT_EQ(result.tree.pathTo(4), (std::vector<int> {0, 1, 2, 3, 4}));
+    EXPECT_TRUE(isTreePlusIsolated(result.tree, 0));
+    EXPECT_TRUE(isSubgraph(result.tree, G));
+  }
+  EXPECT_TRUE(negativeCycleFrom(G, 0).empty());
+  Graph<MyInteger> H(3);
+  H.addEdge(0, 1, MyInteger {5});
+  H.addEdge(1, 2, MyInteger {-3});
+  H.addEdge(0, 2, MyInteger {4});
+  EXPECT_EQ(spfa(H, 0).tree.distance(2), MyInteger {2});
+  EXPECT_EQ(bellmanFord(H, 0, 4).tree.distance(2), MyInteger {2});
+  Graph<double> D(3);
+  D.addEdge(0, 1, 0.5);
+  D.addEdge(1, 2, -0.25);
+  EXPECT_DOUBLE_EQ(bellmanFord(D, 0, 2).tree.distance(2), 0.25);
+  EXPECT_FALSE(spfa(D, 2).tree.reached(0));
+}
+
+TEST(BellmanFordTest, smallNegativeCycle) {
+  Graph<int> G(5);
+  G.addEdge(0, 1, 1);
+  G.addEdge(1, 2, 1);
+  G.addEdge(2, 3, 1);
+  G.addEdge(3, 1, -3);
+  G.addEdge(3, 4, 1);
+  for (const auto& result : {spfa(G, 0), bellmanFord(G, 0, 1), bellmanFord(G, 0, 2)}) {
+    ASSERT_TRUE(result.hasNegativeCycle());
+    isNegativeCycle(result.negativeCycle, G);
+    EXPECT_EQ(result.negativeCycle.size(), 3u);
+  }
+  isNegativeCycle(negativeCycleFrom(G, 0), G);
+  // the cycle cannot be reached from 4
+  EXPECT_FALSE(spfa(G, 4).hasNegativeCycle());
+  EXPECT_FALSE(bellmanFord(G, 4).hasNegativeCycle());
+  Graph<MyInteger> H(2);
+  H.addEdge(0, 1, MyInteger {2});
+  H.addEdge(1, 0, MyInteger {-3});
+  isNegativeCycle(spfa(H, 0).negativeCycle, H);
+  isNegativeCycle(bellmanFord(H, 1).negativeCycle, H);
+}
+
+TEST(BellmanFordTest, randomNegativeWeights) {
+  std::mt19937 mt {8};
+  std::uniform_int_distribution<int> shift {0, 30};
+  for (unsigned seed : {1u, 2u, 3u}) {
+    Graph<int> G {randomGraph(150, seed, 0.04)};
+    std::vector<int> potential(G.size());
+    for (int& p : potential) {
+      p = shift(mt);
+    }
+    Graph<int> H {reweighted(G, potential)};
+    auto dijkstra {singleSourceIndexTree(G, 0)};
+    for (const auto& result : {spfa(H, 0), bellmanFord(H, 0, 1), bellmanFord(H, 0, 4)}) {
+      ASSERT_FALSE(result.hasNegativeCycle());
+      for (int v = 0; v < G.size(); ++v) {
+        if (dijkstra.reached(v)) {
+          EXPECT_EQ(result.tree.distance(v),
+                    dijkstra.distance(v) + potential.at(0) - potential.at(v));
+        } else {
+          EXPECT_FALSE(result.tree.reached(v));
+        }
+      }
+      EXPECT_TRUE(isTreePlusIsolated(result.tree, 0));
+      EXPECT_TRUE(isSubgraph(result.tree, H));
+    }
+    // one edge made very negative closes a negative cycle with the rest
+    int u = dijkstra.pathTo(G.size() - 1).at(1);
+    H.removeEdge(u, 0);
+    H.addEdge(u, 0, -1000);
+    for (const auto& result : {spfa(H, 0), bellmanFord(H, 0, 4)}) {
+      ASSERT_TRUE(result.hasNegativeCycle());
+      isNegativeCycle(result.negativeCycle, H);
+    }
+  }
+}
+
+TEST(BellmanFordTest, badSource) {
+  Graph<int> G(2);
+  EXPECT_THROW(spfa(G, 2), std::out_of_range);
+  EXPECT_THROW(bellmanFord(G, -1), std::out_of_range);
+  EXPECT_THROW(negativeCycleFrom(G, 5), std::out_of_range);
+}
+
+TEST(JohnsonTest, mediumEWD) {
+  CompactGraph<double> G {"mediumEWD.txt"};
+  DistanceMatrix<double> matrix {allPairsShortestPaths(G, 2)};
+  ASSERT_EQ(matrix.numRows(), G.size());
+  for (int source : {0, 99, 249}) {
+    auto tree {singleSourceIndexTree(G, source)};
+    for (int target = 0; target < G.size(); ++target) {
+      EXPECT_NEAR(matrix.at(source, target), tree.distance(target), 1e-9);
+    }
+  }
+}
+
+TEST(JohnsonTest, negativeWeights) {
+  Graph<int> G {randomGraph(80, 12, 0.06)};
+  std::mt19937 mt {12};
+  std::uniform_int_distribution<int> shift {0, 20};
+  std::vector<int> potential(G.size());
+  for (int& p : potential) {
+    p = shift(mt);
+  }
+  Graph<int> H {reweighted(G, potential)};
+  std::vector<int> h {johnsonPotentials(H)};
+  for (int u = 0; u < H.size(); ++u) {
+    for (const auto& [v, weight] : *(H.neighbours(u))) {
+      EXPECT_GE(weight + h.at(u) - h.at(v), 0);
+    }
+  }
+  DistanceMatrix<int> matrix {allPairsShortestPaths(H, 3)};
+  for (int source = 0; source < H.size(); ++source) {
+    auto expected {bellmanFord(H, source).tree};
+    for (int target = 0; target < H.size(); ++target) {
+      EXPECT_EQ(matrix.at(source, target), expected.distance(target));
+    }
+  }
+  Graph<MyInteger> M(3);
+  M.addEdge(0, 1, MyInteger {5});
+  M.addEdge(1, 2, MyInteger {-3});
+  M.addEdge(2, 0, MyInteger {1});
+  DistanceMatrix<MyInteger> small {allPairsShortestPaths(M)};
+  EXPECT_EQ(small.at(0, 2), MyInteger {2});
+  EXPECT_EQ(small.at(2, 1), MyInteger {6});
+  EXPECT_EQ(small.at(1, 0), MyInteger {-2});
+  M.removeEdge(2, 0);
+  M.addEdge(2, 0, MyInteger {-3});
+  EXPECT_THROW(allPairsShortestPaths(M), std::invalid_argument);
+}
+
+TEST(JohnsonTest, mappedFile) {
+  Graph<int> G(4);
+  G.addEdge(0, 1, 4);
+  G.addEdge(1, 2, -2);
+  G.addEdge(2, 3, -2);
+  G.addEdge(0, 3, 2);
+  std::string file {scratchFile("johnson.matrix")};
+  allPairsShortestPathsToFile(G, file, 2, 3);
+  DistanceMatrix<int> loaded {file};
+  EXPECT_EQ(loaded.data(), allPairsShortestPaths(G).data());
+  EXPECT_EQ(loaded.at(0, 3), 0);
+  EXPECT_EQ(loaded.at(3, 0), infinity<int>());
+  CompactGraph<int> medium {"mediumEWD.txt"};
+  allPairsShortestPathsToFile(medium, file, 3, 64);
+  EXPECT_EQ(DistanceMatrix<int> {file}.data(), allPairsShortestPaths(medium).data());
+  std::filesystem::remove(file);
+  EXPECT_THROW(allPairsShortestPathsToFile(G, "no/such/directory/file"),
+               std::runtime_error);
+}
+
+// the forest against one search from an extra vertex N with an edge of
+// weight offset to every source
+void multiSourceMatchesSuperSource(const Graph<int>& G,
+                                   const std::vector<SourceOffset<int> >& sources) {
+  int N = G.size();
+  Graph<int> withSource {N + 1};
+  for (int u = 0; u < N; ++u) {
+    for (const auto& [neighbour, weight] : *(G.neighbours(u))) {
+      withSource.addEdge(u, neighbour, weight);
+    }
+  }
+  for (const auto& [vertex, offset] : sources) {
+    if (!withSource.isEdge(N, vertex) or offset < withSource.getEdgeWeight(N, vertex)) {
+      withSource.removeEdge(N, vertex);
+      withSource.addEdge(N, vertex, offset);
+    }
+  }
+  std::vector<int> expected {singleSourceIndexTree(withSource, N).distances()};
+  expected.pop_back();
+  ShortestPathTree<int> forest {multiSourceIndexTree(G, sources)};
+  ASSERT_EQ(forest.distances(), expected);
+  const std::vector<int>& roots {forest.sources()};
+  for (int v = 0; v < N; ++v) {
+    ASSERT_EQ(forest.reached(v), expected.at(v) != infinity<int>());
+    int p = forest.parent(v);
+    if (p != -1) {
+      ASSERT_TRUE(G.isEdge(p, v));
+      ASSERT_EQ(forest.distance(v), forest.distance(p) + forest.parentWeight(v));
+    } else if (forest.reached(v)) {
+      ASSERT_TRUE(std::binary_search(roots.begin(), roots.end(), v));
+    }
+    if (forest.reached(v)) {
+      int root = forest.pathTo(v).front();
+      ASSERT_TRUE(std::binary_search(roots.begin(), roots.end(), root));
+      ASSERT_EQ(forest.parent(root), -1);
+    }
+  }
+}
+
+TEST(MultiSourceTest, depotsAtDistanceZero) {
+  Graph<int> G {randomGraph(400, 61, 0.01)};
+  std::vector<SourceOffset<int> > depots {};
+  for (int v = 0; v < 400; v += 37) {
+    depots.push_back({v, 0});
+  }
+  multiSourceMatchesSuperSource(G, depots);
+  // a single source is the usual search
+  ShortestPathTree<int> one {multiSourceIndexTree(G, {{5, 0}})};
+  EXPECT_EQ(one.distances(), singleSourceIndexTree(G, 5).distances());
+  EXPECT_TRUE(isTreePlusIsolated(one, 5));
+}
+
+TEST(MultiSourceTest, offsets) {
+  Graph<int> G {randomGraph(300, 62, 0.02)};
+  std::mt19937 mt {63};
+  std::vector<SourceOffset<int> > sources {};
+  for (int k = 0; k < 40; ++k) {
+    sources.push_back({static_cast<int>(mt() % 300), static_cast<int>(mt() % 30)});
+  }
+  // repeated sources keep their smallest offset
+  sources.push_back({sources.front().vertex, 0});
+  multiSourceMatchesSuperSource(G, sources);
+  EXPECT_THROW(multiSourceIndexTree(G, {{300, 0}}), std::out_of_range);
+  ShortestPathTree<int> none {multiSourceIndexTree(G, {})};
+  EXPECT_FALSE(none.reached(0));
+}
+
+// Every allocation through the global operator new in this program is
+// counted, so a test can check a stretch of code allocates nothing.  The
+// aligned forms are replaced too, as std::pmr's default resource uses them
+std::atomic<long long> allocationCount {0};
+
+void* operator new(std::size_t size) {
+  ++allocationCount;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc {};
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  ++allocationCount;
+  auto align = static_cast<std::size_t>(alignment);
+  // aligned_alloc wants a size that is a multiple of the alignment
+  std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+  if (void* p = std::aligned_alloc(align, rounded)) {
+    return p;
+  }
+  throw std::bad_alloc {};
+}
+
+// gcc takes these frees for frees of memory from its own operator new
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+#pragma GCC diagnostic pop
+
+// A query loop like a worker thread's: point to point searches, many
+// stopping early with vertices left in the queue, in one workspace.  After
+// a first round has grown every buffer, repeating the queries must not
+// allocate at all
+TEST(AllocationTest, workspaceQueriesDoNotAllocate) {
+  CompactGraph<int> G {randomGraph(2000, 71, 0.003)};
+  std::mt19937 mt {72};
+  std::vector<std::pair<int, int> > queries(300);
+  for (auto& [source, target] : queries) {
+    source = static_cast<int>(mt() % 2000);
+    target = mt() % 4 == 0 ? -1 : static_cast<int>(mt() % 2000);
+  }
+  DijkstraWorkspace<int> workspace(G.size());
+  std::vector<int> firstRound {};
+  for (const auto& [source, target] : queries) {
+    singleSourceSearch(G, source, workspace, target);
+    firstRound.push_back(target == -1 ? 0 : workspace.distance(target));
+  }
+  long long before = allocationCount;
+  int k = 0;
+  bool same = true;
+  for (const auto& [source, target] : queries) {
+    singleSourceSearch(G, source, workspace, target);
+    same = same and firstRound[k++] == (target == -1 ? 0 : workspace.distance(target));
+  }
+  long long allocations = allocationCount - before;
+  EXPECT_EQ(allocations, 0);
+  EXPECT_TRUE(same);
+}
+
+TEST(AllocationTest, queueAllocatesOnlyWhenBuilt) {
+  int N = 5000;
+  long long before = allocationCount;
+  IndexPriorityQueue<int> queue(N);
+  long long built = allocationCount;
+  std::mt19937 mt {73};
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 0; i < N; ++i) {
+      queue.changeKey(static_cast<int>(mt() % 1000), static_cast<int>(mt() % N));
+    }
+    for (int i = 0; i < N / 2 and !queue.empty(); ++i) {
+      queue.pop();
+    }
+    queue.clear();
+  }
+  long long allocations = allocationCount - built;
+  EXPECT_EQ(built - before, 3);
+  EXPECT_EQ(allocations, 0);
+}
 
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -8,6 +8,8 @@ struct MyInteger {
   inline static int constructorCount = 0;
   inline static int copyCount = 0;
   inline static int assignmentCount = 0;
+  // move constructions and move assignments together
+  inline static int moveCount = 0;
   inline static int equalityCount = 0;
   inline static int comparisonCount = 0;
 
@@ -28,10 +30,22 @@ struct MyInteger {
     return *this;
   }
 
+  MyInteger(MyInteger&& other) noexcept {
+    ++moveCount;
+    value = other.value;
+  }
+
+  MyInteger& operator=(MyInteger&& other) noexcept {
+    ++moveCount;
+    value = other.value;
+    return *this;
+  }
+
   static void printCounts() {
     std::cout << "constructor count is " << constructorCount << '\n';
     std::cout << "copy count is " << copyCount << '\n';
     std::cout << "assignment count is " << assignmentCount << '\n';
+    std::cout << "move count is " << moveCount << '\n';
     std::cout << "comparison count is " << comparisonCount << '\n';
   }
 
@@ -39,6 +53,7 @@ struct MyInteger {
     constructorCount = 0;
     copyCount = 0;
     assignmentCount = 0;
+    moveCount = 0;
     equalityCount = 0;
     comparisonCount = 0;
   }
@@ -0,0 +1,225 @@
+#ifndef QUERY_EXECUTOR_HPP_
+#define QUERY_EXECUTOR_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "graph.hpp"
+#include "dijkstra_workspace.hpp"
+#include "thread_pool.hpp"
+
+// One request to a QueryExecutor: a Dijkstra search from source that
+// stops once target is settled, if there is a target (-1 for none), and
+// does not settle vertices farther away than radius, if there is one.
+template <typename T>
+struct DistanceQuery {
+  int source {};
+  int target = -1;
+  std::optional<T> radius {};
+};
+
+template <typename T>
+struct QueryAnswer {
+  // distance to the target, infinity<T>() if there is no target or it was
+  // not reached (within the radius)
+  T distance {};
+  // number of vertices settled; for a query with only a radius this is the
+  // number of vertices within the radius
+  int settled = 0;
+};
+
+// Latencies of the queries of a batch in seconds, from starting a search
+// to having its answer
+struct LatencyReport {
+  int count = 0;
+  double mean = 0;
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double max = 0;
+  // wall clock time for the whole batch and queries per second
+  double seconds = 0;
+  double throughput = 0;
+};
+
+template <typename T>
+struct BatchResult {
+  // answers in the order of the queries
+  std::vector<QueryAnswer<T> > answers {};
+  LatencyReport latency {};
+};
+
+// p-th percentile (0 < p <= 100) of sorted values by the nearest rank
+// method, 0 for no values
+inline double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100 * sorted.size()));
+  return sorted.at(std::clamp<std::size_t>(rank, 1, sorted.size()) - 1);
+}
+
+// Runs batches of queries on one graph on a fixed set of threads.  The
+// graph is shared read-only and every thread owns a DijkstraWorkspace, so
+// queries allocate nothing and threads only meet when taking work.
+//
+// Work is spread by work stealing: a batch is split into one contiguous
+// share per thread, each thread works through its own share from the
+// front, and a thread that runs out takes queries from the back of
+// another thread's share.  Queries differ a lot in cost (a nearby target
+// against a search of the whole graph), and stealing keeps every thread
+// busy until the batch is done without a central queue all threads
+// contend on.
+//
+// The number of threads goes through effectiveThreads.
+template <typename T, template <typename> class GraphType>
+class QueryExecutor {
+ private:
+  struct WorkDeque {
+    std::mutex mutex {};
+    std::deque<int> queries {};
+  };
+
+  const GraphType<T>& G;
+  ThreadPool pool;
+  std::vector<DijkstraWorkspace<T> > workspaces {};
+  std::vector<std::unique_ptr<WorkDeque> > deques {};
+
+ public:
+  // G must outlive the executor
+  explicit QueryExecutor(const GraphType<T>& G,
+                         int numThreads = defaultThreadCount());
+
+  int numThreads() const;
+
+  // answer all queries, throws std::out_of_range before starting if a
+  // query names a vertex that is not in the graph
+  BatchResult<T> run(const std::vector<DistanceQuery<T> >& queries);
+
+ private:
+  // next query for thread, its own or a stolen one, -1 once there are none
+  int nextQuery(int thread);
+
+  QueryAnswer<T> answer(const DistanceQuery<T>& query,
+                        DijkstraWorkspace<T>& workspace) const;
+};
+
+template <typename T, template <typename> class GraphType>
+QueryExecutor<T, GraphType>::QueryExecutor(const GraphType<T>& G, int numThreads)
+    : G {G},
+      pool {effectiveThreads<T>(numThreads)} {
+  workspaces.assign(pool.size(), DijkstraWorkspace<T>(G.size()));
+  for (int thread = 0; thread < pool.size(); ++thread) {
+    deques.push_back(std::make_unique<WorkDeque>());
+  }
+}
+
+template <typename T, template <typename> class GraphType>
+int QueryExecutor<T, GraphType>::numThreads() const {
+  return pool.size();
+}
+
+template <typename T, template <typename> class GraphType>
+BatchResult<T> QueryExecutor<T, GraphType>::run(
+    const std::vector<DistanceQuery<T> >& queries) {
+  int N = G.size();
+  for (const DistanceQuery<T>& query : queries) {
+    if (query.source < 0 or query.source >= N or query.target < -1
+        or query.target >= N) {
+      throw std::out_of_range("invalid vertex number");
+    }
+  }
+  int numQueries = static_cast<int>(queries.size());
+  int threads = numThreads();
+  for (int thread = 0; thread < threads; ++thread) {
+    std::deque<int>& share = deques.at(thread)->queries;
+    share.clear();
+    for (int i = thread * numQueries / threads;
+         i < (thread + 1) * numQueries / threads; ++i) {
+      share.push_back(i);
+    }
+  }
+  BatchResult<T> result {};
+  result.answers.resize(numQueries);
+  std::vector<double> latencies(numQueries);
+  using Clock = std::chrono::steady_clock;
+  auto batchStart = Clock::now();
+  pool.run([&](int thread) {
+    for (int i = nextQuery(thread); i != -1; i = nextQuery(thread)) {
+      auto start = Clock::now();
+      result.answers[i] = answer(queries[i], workspaces.at(thread));
+      latencies[i] = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+  });
+  LatencyReport& report = result.latency;
+  report.seconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+  report.count = numQueries;
+  if (numQueries > 0) {
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double latency : latencies) {
+      total += latency;
+    }
+    report.mean = total / numQueries;
+    report.p50 = percentile(latencies, 50);
+    report.p90 = percentile(latencies, 90);
+    report.p99 = percentile(latencies, 99);
+    report.max = latencies.back();
+    report.throughput = report.seconds > 0 ? numQueries / report.seconds : 0;
+  }
+  return result;
+}
+
+template <typename T, template <typename> class GraphType>
+int QueryExecutor<T, GraphType>::nextQuery(int thread) {
+  {
+    WorkDeque& own = *deques.at(thread);
+    std::lock_guard<std::mutex> lock {own.mutex};
+    if (!own.queries.empty()) {
+      int query = own.queries.front();
+      own.queries.pop_front();
+      return query;
+    }
+  }
+  // no new work appears during a batch, so once every share is empty
+  // this thread is done
+  int threads = numThreads();
+  for (int offset = 1; offset < threads; ++offset) {
+    WorkDeque& victim = *deques.at((thread + offset) % threads);
+    std::lock_guard<std::mutex> lock {victim.mutex};
+    if (!victim.queries.empty()) {
+      int query = victim.queries.back();
+      victim.queries.pop_back();
+      return query;
+    }
+  }
+  return -1;
+}
+
+template <typename T, template <typename> class GraphType>
+QueryAnswer<T> QueryExecutor<T, GraphType>::answer(
+    const DistanceQuery<T>& query, DijkstraWorkspace<T>& workspace) const {
+  QueryAnswer<T> result {infinity<T>(), 0};
+  workspaceSearch(G, query.source, workspace,
+                  [&query](const T& dist) {
+                    return query.radius and *query.radius < dist;
+                  },
+                  [&](int current, const T& dist) {
+                    ++result.settled;
+                    if (current != query.target) {
+                      return false;
+                    }
+                    result.distance = dist;
+                    return true;
+                  });
+  return result;
+}
+
+#endif      // QUERY_EXECUTOR_HPP_
@@ -0,0 +1,294 @@
+#ifndef RADIX_HEAP_HPP_
+#define RADIX_HEAP_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "my_integer.hpp"
+
+// Radix heaps are priority queues for non-negative integer keys that are
+// used monotonically: a key pushed is never smaller than the last key
+// popped.  Dijkstra's algorithm with non-negative weights uses its queue
+// exactly this way.
+//
+// Keys are kept in 33 buckets relative to last, the most recently
+// popped key.  Bucket 0 holds keys equal to last and bucket b > 0 holds
+// keys whose highest bit differing from last is bit b - 1.  A push is
+// O(1).  When bucket 0 runs empty the first non-empty bucket is emptied
+// into lower buckets around its minimum; every key can only move down, so
+// a pop costs O(log C) amortised where C is the largest key.
+//
+// Refilling bucket 0 moves last up to the current minimum, so it is done
+// as late as possible, by top() or pop().  For that reason top() is not
+// const here, unlike in IndexPriorityQueue.
+//
+// Both queues work with int and MyInteger priorities and never compare
+// priorities with each other.
+
+// the unsigned key a priority is sorted by
+inline unsigned radixKey(int priority) {
+  if (priority < 0) {
+    throw std::invalid_argument("radix heap keys must not be negative");
+  }
+  return static_cast<unsigned>(priority);
+}
+
+inline unsigned radixKey(const MyInteger& priority) {
+  return radixKey(priority.value);
+}
+
+// which bucket key belongs in when the last key popped was last
+inline int radixBucket(unsigned key, unsigned last) {
+  return std::bit_width(key ^ last);
+}
+
+constexpr int numRadixBuckets = 33;
+
+// Radix heap holding (priority, vertex) pairs, with the same interface as
+// the std::priority_queue in singleSourceLazy so it can be used with
+// singleSourceLazyWith.  A vertex can be pushed more than once.
+template <typename T>
+class RadixHeap {
+ private:
+  std::array<std::vector<std::pair<unsigned, int> >, numRadixBuckets> buckets {};
+  unsigned last = 0;
+  int size_ = 0;
+
+ public:
+  void push(const std::pair<T, int>& entry);
+  void pop();
+  std::pair<T, int> top();
+  bool empty() const;
+  int size() const;
+
+ private:
+  void refill();
+};
+
+template <typename T>
+void RadixHeap<T>::push(const std::pair<T, int>& entry) {
+  unsigned key = radixKey(entry.first);
+  if (key < last) {
+    throw std::invalid_argument("radix heap keys must not decrease");
+  }
+  buckets[radixBucket(key, last)].push_back({key, entry.second});
+  ++size_;
+}
+
+template <typename T>
+void RadixHeap<T>::pop() {
+  if (size_ == 0) {
+    return;
+  }
+  refill();
+  buckets[0].pop_back();
+  --size_;
+}
+
+template <typename T>
+std::pair<T, int> RadixHeap<T>::top() {
+  if (size_ == 0) {
+    return {T {}, 0};
+  }
+  refill();
+  return {T(static_cast<int>(last)), buckets[0].back().second};
+}
+
+template <typename T>
+bool RadixHeap<T>::empty() const {
+  return size_ == 0;
+}
+
+template <typename T>
+int RadixHeap<T>::size() const {
+  return size_;
+}
+
+// if bucket 0 is empty, move the smallest keys into it
+template <typename T>
+void RadixHeap<T>::refill() {
+  if (not buckets[0].empty()) {
+    return;
+  }
+  int b = 1;
+  while (buckets[b].empty()) {
+    ++b;
+  }
+  unsigned smallest = buckets[b].front().first;
+  for (const auto& entry : buckets[b]) {
+    smallest = std::min(smallest, entry.first);
+  }
+  last = smallest;
+  for (const auto& entry : buckets[b]) {
+    buckets[radixBucket(entry.first, last)].push_back(entry);
+  }
+  buckets[b].clear();
+}
+
+// Radix heap where each index 0, ..., N - 1 appears at most once, with the
+// interface of IndexPriorityQueue so it can be used with
+// singleSourceIndexWith.  changeKey moves an index between buckets in O(1)
+// as long as the new key is not below the last key popped.
+template <typename T>
+class IndexRadixHeap {
+ private:
+  std::array<std::vector<int>, numRadixBuckets> buckets {};
+  // for an index in the heap: its key, its bucket, and where in that
+  // bucket it is.  bucketOf.at(i) is -1 if i is not in the heap
+  std::vector<unsigned> keyOf {};
+  std::vector<int> bucketOf {};
+  std::vector<int> positionInBucket {};
+  unsigned last = 0;
+  int size_ = 0;
+
+ public:
+  explicit IndexRadixHeap(int N);
+  void push(const T& priority, int index);
+  void pop();
+  void erase(int index);
+  bool contains(int index) const;
+  void changeKey(const T& priority, int index);
+  std::pair<T, int> top();
+  // index of the minimum, as top().second
+  int topIndex();
+  bool empty() const;
+  int size() const;
+
+ private:
+  void insert(unsigned key, int index);
+  void remove(int index);
+  void refill();
+};
+
+template <typename T>
+IndexRadixHeap<T>::IndexRadixHeap(int N)
+    : keyOf(N), bucketOf(N, -1), positionInBucket(N) {}
+
+template <typename T>
+void IndexRadixHeap<T>::insert(unsigned key, int index) {
+  if (key < last) {
+    throw std::invalid_argument("radix heap keys must not decrease");
+  }
+  int b = radixBucket(key, last);
+  keyOf.at(index) = key;
+  bucketOf.at(index) = b;
+  positionInBucket.at(index) = static_cast<int>(buckets[b].size());
+  buckets[b].push_back(index);
+  ++size_;
+}
+
+// take index out of its bucket by moving the bucket's last entry into its place
+template <typename T>
+void IndexRadixHeap<T>::remove(int index) {
+  std::vector<int>& bucket = buckets[bucketOf.at(index)];
+  int position = positionInBucket.at(index);
+  int moved = bucket.back();
+  bucket[position] = moved;
+  positionInBucket.at(moved) = position;
+  bucket.pop_back();
+  bucketOf.at(index) = -1;
+  --size_;
+}
+
+template <typename T>
+void IndexRadixHeap<T>::refill() {
+  if (not buckets[0].empty()) {
+    return;
+  }
+  int b = 1;
+  while (buckets[b].empty()) {
+    ++b;
+  }
+  unsigned smallest = keyOf.at(buckets[b].front());
+  for (int index : buckets[b]) {
+    smallest = std::min(smallest, keyOf.at(index));
+  }
+  last = smallest;
+  std::vector<int> emptied {};
+  std::swap(emptied, buckets[b]);
+  for (int index : emptied) {
+    int lower = radixBucket(keyOf.at(index), last);
+    bucketOf.at(index) = lower;
+    positionInBucket.at(index) = static_cast<int>(buckets[lower].size());
+    buckets[lower].push_back(index);
+  }
+  // hand the storage back so the bucket does not allocate again
+  emptied.clear();
+  std::swap(emptied, buckets[b]);
+}
+
+template <typename T>
+void IndexRadixHeap<T>::push(const T& priority, int index) {
+  if (contains(index)) {
+    return;
+  }
+  insert(radixKey(priority), index);
+}
+
+template <typename T>
+void IndexRadixHeap<T>::pop() {
+  if (size_ == 0) {
+    return;
+  }
+  refill();
+  remove(buckets[0].back());
+}
+
+template <typename T>
+void IndexRadixHeap<T>::erase(int index) {
+  if (!contains(index)) {
+    return;
+  }
+  remove(index);
+}
+
+template <typename T>
+bool IndexRadixHeap<T>::contains(int index) const {
+  if (index < 0 or index >= static_cast<int>(bucketOf.size())) {
+    return false;
+  }
+  return bucketOf.at(index) != -1;
+}
+
+// if index is not present, insert it with priority
+// otherwise move it to the bucket for its new priority
+template <typename T>
+void IndexRadixHeap<T>::changeKey(const T& priority, int index) {
+  unsigned key = radixKey(priority);
+  if (key < last) {
+    throw std::invalid_argument("radix heap keys must not decrease");
+  }
+  if (contains(index)) {
+    remove(index);
+  }
+  insert(key, index);
+}
+
+template <typename T>
+std::pair<T, int> IndexRadixHeap<T>::top() {
+  if (size_ == 0) {
+    return {T {}, 0};
+  }
+  refill();
+  return {T(static_cast<int>(last)), buckets[0].back()};
+}
+
+template <typename T>
+int IndexRadixHeap<T>::topIndex() {
+  return top().second;
+}
+
+template <typename T>
+bool IndexRadixHeap<T>::empty() const {
+  return size_ == 0;
+}
+
+template <typename T>
+int IndexRadixHeap<T>::size() const {
+  return size_;
+}
+
+#endif      // RADIX_HEAP_HPP_
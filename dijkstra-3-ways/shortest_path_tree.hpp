@@ -0,0 +1,162 @@
+#ifndef SHORTEST_PATH_TREE_HPP_
+#define SHORTEST_PATH_TREE_HPP_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class Graph;
+
+// Result of a single source shortest path search stored as three arrays
+// indexed by vertex: the parent on a shortest path, the distance from the
+// source and the weight of the edge from the parent.  Building it costs
+// nothing beyond the arrays the search keeps anyway, whereas building a
+// Graph<T> costs a hash map per vertex and a hash insert per edge.
+// Paths are only put together when asked for, and toGraph() gives the
+// equivalent Graph<T> if one is really needed.
+//
+// A search from several sources gives a shortest path forest instead: the
+// same arrays, with every vertex reached from the nearest source, which
+// is the root of its tree.
+template <typename T>
+class ShortestPathTree {
+ private:
+  int source_ {};
+  // all sources, sorted; just source_ for a single source search
+  std::vector<int> sources_ {};
+  // parent_.at(v) is -1 for the source and for unreached vertices
+  std::vector<int> parent_ {};
+  std::vector<T> distance_ {};
+  std::vector<T> parentWeight_ {};
+
+ public:
+  // take over the arrays of a finished search.  distance should hold
+  // infinity<T>() for unreached vertices, parentWeight.at(v) only matters
+  // when parent.at(v) != -1
+  ShortestPathTree(int source, std::vector<int> parent,
+                   std::vector<T> distance, std::vector<T> parentWeight);
+
+  // the same for a search from every vertex in sources
+  ShortestPathTree(std::vector<int> sources, std::vector<int> parent,
+                   std::vector<T> distance, std::vector<T> parentWeight);
+
+  // number of vertices
+  int size() const;
+
+  // the first source of a multi source search
+  int source() const;
+
+  const std::vector<int>& sources() const;
+
+  // is there a path from the source to v?
+  bool reached(int v) const;
+
+  // vertex before v on a shortest path, -1 for the source and
+  // unreached vertices
+  int parent(int v) const;
+
+  // length of a shortest path from the source to v
+  const T& distance(int v) const;
+
+  // weight of the edge parent(v) -> v
+  const T& parentWeight(int v) const;
+
+  // all distances, indexed by vertex
+  const std::vector<T>& distances() const;
+
+  // vertices on a shortest path from the source to v, starting with the
+  // source (the root of v's tree in a forest).  Empty if v is not reached
+  std::vector<int> pathTo(int v) const;
+
+  // the tree as a graph with an edge parent(v) -> v for each reached v
+  Graph<T> toGraph() const;
+};
+
+template <typename T>
+ShortestPathTree<T>::ShortestPathTree(int source, std::vector<int> parent,
+                                      std::vector<T> distance,
+                                      std::vector<T> parentWeight)
+    : source_ {source}, sources_ {source}, parent_ {std::move(parent)},
+      distance_ {std::move(distance)},
+      parentWeight_ {std::move(parentWeight)} {}
+
+template <typename T>
+ShortestPathTree<T>::ShortestPathTree(std::vector<int> sources,
+                                      std::vector<int> parent,
+                                      std::vector<T> distance,
+                                      std::vector<T> parentWeight)
+    : source_ {sources.empty() ? -1 : sources.front()},
+      sources_ {std::move(sources)}, parent_ {std::move(parent)},
+      distance_ {std::move(distance)},
+      parentWeight_ {std::move(parentWeight)} {
+  std::sort(sources_.begin(), sources_.end());
+  sources_.erase(std::unique(sources_.begin(), sources_.end()), sources_.end());
+}
+
+template <typename T>
+int ShortestPathTree<T>::size() const {
+  return static_cast<int>(parent_.size());
+}
+
+template <typename T>
+int ShortestPathTree<T>::source() const {
+  return source_;
+}
+
+template <typename T>
+const std::vector<int>& ShortestPathTree<T>::sources() const {
+  return sources_;
+}
+
+template <typename T>
+bool ShortestPathTree<T>::reached(int v) const {
+  return v == source_ or parent_.at(v) != -1
+         or std::binary_search(sources_.begin(), sources_.end(), v);
+}
+
+template <typename T>
+int ShortestPathTree<T>::parent(int v) const {
+  return parent_.at(v);
+}
+
+template <typename T>
+const T& ShortestPathTree<T>::distance(int v) const {
+  return distance_.at(v);
+}
+
+template <typename T>
+const T& ShortestPathTree<T>::parentWeight(int v) const {
+  return parentWeight_.at(v);
+}
+
+template <typename T>
+const std::vector<T>& ShortestPathTree<T>::distances() const {
+  return distance_;
+}
+
+template <typename T>
+std::vector<int> ShortestPathTree<T>::pathTo(int v) const {
+  std::vector<int> path {};
+  if (!reached(v)) {
+    return path;
+  }
+  for (int current = v; current != -1; current = parent_.at(current)) {
+    path.push_back(current);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+template <typename T>
+Graph<T> ShortestPathTree<T>::toGraph() const {
+  Graph<T> shortestPath {size()};
+  for (int v = 0; v < size(); ++v) {
+    if (parent_.at(v) != -1) {
+      shortestPath.addEdge(parent_.at(v), v, parentWeight_.at(v));
+    }
+  }
+  return shortestPath;
+}
+
+#endif      // SHORTEST_PATH_TREE_HPP_
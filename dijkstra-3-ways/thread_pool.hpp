@@ -0,0 +1,140 @@
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed set of threads for algorithms that work in rounds, such as
+// delta-stepping.  run(task) calls task(t) once for every thread number
+// t = 0, ..., size() - 1 and waits until all of them have finished, so
+// everything written in one round is visible to every thread in the next.
+// The calling thread does the work of thread 0, so a pool of size 1 starts
+// no threads at all.
+class ThreadPool {
+ private:
+  std::vector<std::thread> workers {};
+  std::mutex mutex {};
+  std::condition_variable workReady {};
+  std::condition_variable workDone {};
+  const std::function<void(int)>* task {nullptr};
+  // bumped by each run so a worker knows there is a new round
+  unsigned long long round = 0;
+  int stillRunning = 0;
+  bool stopping = false;
+  std::exception_ptr failure {};
+
+ public:
+  // pool with numThreads threads including the calling thread
+  explicit ThreadPool(int numThreads);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  // number of threads, including the calling thread
+  int size() const;
+
+  // call task(t) on thread t for every t and wait for all of them.
+  // If a task throws, the first exception is rethrown here.
+  void run(const std::function<void(int)>& roundTask);
+
+ private:
+  void work(int id);
+  void runAndRecord(int id);
+};
+
+inline int defaultThreadCount() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+struct MyInteger;
+
+// Number of threads a parallel engine should use when asked for
+// numThreads: at least 1, and exactly 1 with MyInteger weights, as
+// MyInteger counts its operations in unsynchronised static counters that
+// threads would race on.
+template <typename T>
+int effectiveThreads(int numThreads) {
+  if constexpr (std::is_same_v<T, MyInteger>) {
+    return 1;
+  }
+  return std::max(1, numThreads);
+}
+
+inline ThreadPool::ThreadPool(int numThreads) {
+  for (int id = 1; id < numThreads; ++id) {
+    workers.emplace_back(&ThreadPool::work, this, id);
+  }
+}
+
+inline ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock {mutex};
+    stopping = true;
+  }
+  workReady.notify_all();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+inline int ThreadPool::size() const {
+  return static_cast<int>(workers.size()) + 1;
+}
+
+inline void ThreadPool::run(const std::function<void(int)>& roundTask) {
+  {
+    std::lock_guard<std::mutex> lock {mutex};
+    task = &roundTask;
+    stillRunning = static_cast<int>(workers.size());
+    failure = nullptr;
+    ++round;
+  }
+  workReady.notify_all();
+  runAndRecord(0);
+  std::unique_lock<std::mutex> lock {mutex};
+  workDone.wait(lock, [this] { return stillRunning == 0; });
+  task = nullptr;
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+inline void ThreadPool::runAndRecord(int id) {
+  try {
+    (*task)(id);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock {mutex};
+    if (!failure) {
+      failure = std::current_exception();
+    }
+  }
+}
+
+inline void ThreadPool::work(int id) {
+  unsigned long long roundsSeen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock {mutex};
+      workReady.wait(lock, [&] { return stopping or round != roundsSeen; });
+      if (stopping) {
+        return;
+      }
+      roundsSeen = round;
+    }
+    runAndRecord(id);
+    {
+      std::lock_guard<std::mutex> lock {mutex};
+      --stillRunning;
+    }
+    workDone.notify_one();
+  }
+}
+
+#endif      // THREAD_POOL_HPP_
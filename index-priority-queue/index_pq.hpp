@@ -3,35 +3,76 @@
 
 #include <vector>
 #include <algorithm>
+#include <iostream>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
 
-template <typename T>
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define INDEX_PQ_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Arity is the number of children of each node in the heap.  The default
+// of 2 gives the usual binary heap; a wider heap such as 4 or 8 is
+// shallower, so swim (used by push and changeKey) does fewer steps and
+// sink looks at children that sit next to each other in memory.
+template <typename T, int Arity = 2>
 class IndexPriorityQueue {
+  static_assert(Arity >= 2, "a heap node needs at least two children");
+
  private:
   // vector to hold priorities.  
   // priorities.at(i) is the priority associated to index i
   // the heap will only contain indices, we look up priorities
   // in this vector as needed
-  std::vector<T> priorities {};
+  std::pmr::vector<T> priorities {};
   // priorityQueue stores indices: priorityQueue.at(i) is an index
   // priorityQueue functions as the heap and is heap ordered: 
-  // priorities.at(priorityQueue.at(i)) <= priorities.at(priorityQueue.at(2 * i)) 
-  // priorities.at(priorityQueue.at(i)) <= priorities.at(priorityQueue.at(2 * i) + 1) 
-  std::vector<int> priorityQueue {};
+  // priorities.at(priorityQueue.at(i)) <= priorities.at(priorityQueue.at(c))
+  // for every child c of i, that is firstChild(i, Arity) <= c < firstChild(i, Arity) + Arity
+  // (for a binary heap the children are 2 * i and 2 * i + 1)
+  std::pmr::vector<int> priorityQueue {};
   // indexToPosition.at(i) is the position in priorityQueue of index i
   // priorityQueue.at(indexToPosition.at(i)) = i
   // indexToPosition.at(priorityQueue.at(j)) = j
-  std::vector<int> indexToPosition {};
+  std::pmr::vector<int> indexToPosition {};
   int size_ = 0;
   int maxSize_ = 0; // newly added
 
  public:
   explicit IndexPriorityQueue(int);
+  // a queue whose arrays come from arena, for example a
+  // std::pmr::monotonic_buffer_resource over a preallocated buffer.  All
+  // memory is taken here: the queue does not allocate after construction
+  IndexPriorityQueue(int, std::pmr::memory_resource* arena);
+  // a queue holding the (priority, index) pairs in entries, built by assign
+  IndexPriorityQueue(int, const std::vector<std::pair<T, int> >& entries);
   void push(const T&, int);
+  // push and changeKey taking the priority by rvalue move it into the
+  // queue instead of copying it, which matters for large priority types
+  void push(T&&, int);
+  // push a priority constructed from args
+  template <typename... Args>
+  void emplace(int, Args&&... args);
+  // replace the contents with the (priority, index) pairs in entries.  The
+  // heap is built bottom up in O(size) time instead of O(size log size)
+  // for pushing them one by one.  Like push, an index that appears again
+  // keeps its first priority.  Throws std::out_of_range, leaving the queue
+  // as it was, if an index is not below N
+  void assign(const std::vector<std::pair<T, int> >& entries);
+  // remove everything, in time proportional to size() rather than N
+  void clear();
   void pop();
   void erase(int);
   bool contains(int) const;
   void changeKey(const T&, int);
+  void changeKey(T&&, int);
   std::pair<T, int> top() const;
+  // the minimum priority and its index without copying the priority.
+  // Both throw std::out_of_range if the queue is empty
+  const T& topKey() const;
+  int topIndex() const;
   bool empty() const;
   int size() const;
   int maxSize() const; //initialises to be the maximum size which is N in the constructor, to then be used in contains to check if index is within range.
@@ -39,48 +80,75 @@ class IndexPriorityQueue {
  private:
   void swim(int i); 
   void sink(int index);
+  // add name to the heap once its priority is in place
+  void insertStored(int name);
 };
 
 // Useful helper functions
-int leftChild(int i) {
+inline int leftChild(int i) {
   return 2*i;
 }
 
-int rightChild(int i) {
+inline int rightChild(int i) {
   return 2*i + 1;
 }
 
-int parent(int i) {
+inline int parent(int i) {
   return i/2;
 }
 
+// The same helpers for a heap where every node has arity children.
+// Positions start at 1 as above, so the children of i are
+// firstChild(i, arity), ..., firstChild(i, arity) + arity - 1
+inline int firstChild(int i, int arity) {
+  return arity*(i - 1) + 2;
+}
+
+// only meaningful for i > 1, the root has no parent
+inline int parent(int i, int arity) {
+  return (i - 2)/arity + 1;
+}
+
 //Difficult
 // IndexPriorityQueue member functions
-template <typename T>
-IndexPriorityQueue<T>::IndexPriorityQueue(int N) { //Constructor
+template <typename T, int Arity>
+IndexPriorityQueue<T, Arity>::IndexPriorityQueue(int N) //Constructor
+    : IndexPriorityQueue(N, std::pmr::get_default_resource()) {}
+
+template <typename T, int Arity>
+IndexPriorityQueue<T, Arity>::IndexPriorityQueue(int N, std::pmr::memory_resource* arena)
+    : priorities(arena), priorityQueue(arena), indexToPosition(arena) {
+  priorityQueue.reserve(N + 1); //room for every index, so push never reallocates.
   priorityQueue.push_back(int {});
   priorities.resize(N);
   indexToPosition.resize(N, -1);
   size_ = 0; 
   maxSize_ = N; //initialises to be the maximum size which is N to later on be used in contains to check if index is within range.
 }
-template <typename T>
-bool IndexPriorityQueue<T>::empty() const { 
+template <typename T, int Arity>
+IndexPriorityQueue<T, Arity>::IndexPriorityQueue(
+    int N, const std::vector<std::pair<T, int> >& entries)
+    : IndexPriorityQueue(N) {
+  assign(entries);
+}
+
+template <typename T, int Arity>
+bool IndexPriorityQueue<T, Arity>::empty() const { 
   return size_ == 0;
 }
 
-template <typename T>
-int IndexPriorityQueue<T>::size() const {
+template <typename T, int Arity>
+int IndexPriorityQueue<T, Arity>::size() const {
   return size_;
 }
 
-template <typename T> //returns the max size as N to later be called in contains.
-int IndexPriorityQueue<T>::maxSize() const {
+template <typename T, int Arity> //returns the max size as N to later be called in contains.
+int IndexPriorityQueue<T, Arity>::maxSize() const {
   return maxSize_;
 }
 
-template <typename T> 
-void IndexPriorityQueue<T>::push(const T& priority, int name) {
+template <typename T, int Arity> 
+void IndexPriorityQueue<T, Arity>::push(const T& priority, int name) {
   
   if (contains(name)){ //if element with parameter name is already in the priority queue,-
     return; //-don't push. (return)
@@ -93,10 +161,77 @@ void IndexPriorityQueue<T>::push(const T& priority, int name) {
   swim(size_); //swim the new element upwards (swim checks if this is needed).
 } 
 
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::push(T&& priority, int name) {
+  if (contains(name)) {
+    return;
+  }
+  priorities.at(name) = std::move(priority);
+  insertStored(name);
+}
+
+template <typename T, int Arity>
+template <typename... Args>
+void IndexPriorityQueue<T, Arity>::emplace(int name, Args&&... args) {
+  if (contains(name)) {
+    return;
+  }
+  priorities.at(name) = T(std::forward<Args>(args)...);
+  insertStored(name);
+}
+
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::insertStored(int name) {
+  priorityQueue.push_back(name);
+  ++size_;
+  indexToPosition.at(name) = size_;
+  swim(size_);
+}
+
+
+// Floyd's heap construction: put every entry in the heap array as it
+// comes, then sink each node that has children, from the last one up to
+// the root.  Most nodes are near the bottom and sink only a level or two.
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::assign(const std::vector<std::pair<T, int> >& entries) {
+  // check every index first, so a bad one does not leave a half built heap
+  for (const auto& entry : entries) {
+    if (entry.second < 0 || entry.second >= maxSize_) {
+      throw std::out_of_range("invalid index");
+    }
+  }
+  clear();
+  for (const auto& [priority, name] : entries) {
+    if (contains(name)) {
+      continue;
+    }
+    indexToPosition.at(name) = size_ + 1;
+    priorityQueue.push_back(name);
+    ++size_;
+    priorities.at(name) = priority;
+  }
+  if (size_ > 1) {
+    for (int position = parent(size_, Arity); position >= 1; --position) {
+      sink(position);
+    }
+  }
+}
+
+// only the indices in the heap are marked absent again; priorities of
+// absent indices are never read, so they are left as they are
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::clear() {
+  for (int position = 1; position <= size_; ++position) {
+    indexToPosition.at(priorityQueue.at(position)) = -1;
+  }
+  priorityQueue.resize(1);
+  size_ = 0;
+}
+
 
 //Remove the element with the minimum priority (first element in the a minimum heap).
-template <typename T>
-void IndexPriorityQueue<T>::pop() {
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::pop() {
   //check if elements in heap exist first
   if (size_ == 0){
     std::cout << "no elements in the heap" << '\n';
@@ -113,8 +248,8 @@ void IndexPriorityQueue<T>::pop() {
 
 //Erase removes the index that the user prompts to remove at index. Similar to pop, however, it removes any index is pleases
 //the index to be removed is swapped with the size_(last element) and then popped the heap is popped back(deletes the last element in the heap which is the index).
-template <typename T>
-void IndexPriorityQueue<T>::erase(int index) { 
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::erase(int index) { 
   if (!contains(index)){ //if the element being called to be erased does not exist, do nothing as there is nothing to erase.
     return;
   }
@@ -144,15 +279,18 @@ to prevent swimming a position that doesn't exist, we check if the index being c
 
 
 /* Sink plays a role in maintaining the minimum heap by replacing(or sinking) heap elements down the heap into the correct position if an element was larger than its child */
-template <typename T>
-void IndexPriorityQueue<T>::sink(int position) {
-  for (int current = position; leftChild(current) <= size_;) { //begin iterating from position as long as the left child is at most the size.
-    int left = leftChild(current);
-    int elementToSwap = left; //element that will be swapped with.
-
-/* if the right child is at most the size and the priority of the left child is larger than the right child, we look into swapping the current with the right child. */
-    if (left + 1 <= size_ && priorities.at(priorityQueue.at(left)) > priorities.at(priorityQueue.at(left + 1))){ 
-      ++elementToSwap;
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::sink(int position) {
+  for (int current = position; firstChild(current, Arity) <= size_;) { //begin iterating from position as long as the first child is at most the size.
+    int first = firstChild(current, Arity);
+    int last = std::min(first + Arity - 1, size_); //the children of current that are in the heap are first, ..., last.
+    int elementToSwap = first; //element that will be swapped with.
+
+/* look through the remaining children for the one with the smallest priority, that is the child we look into swapping the current with. */
+    for (int child = first + 1; child <= last; ++child) {
+      if (priorities.at(priorityQueue.at(elementToSwap)) > priorities.at(priorityQueue.at(child))){
+        elementToSwap = child;
+      }
     }
     //if the priority of the current element is smaller or equal to the priority of the child it's swapping with, return as the min heap order is maintained.
     if (priorities.at(priorityQueue.at(current)) <= priorities.at(priorityQueue.at(elementToSwap))){ 
@@ -165,12 +303,13 @@ void IndexPriorityQueue<T>::sink(int position) {
 }
 
 /* Swim plays a role in maintaining the minimum heap by replacing(or swimming) heap elements up the heap into the correct position if an element was smaller than its parent */
-template <typename T>
-void IndexPriorityQueue<T>::swim(int i) {
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::swim(int i) {
   //let's say to swim, we intitalise p to be the parent of
   // it's child, i
-  //we then check loop as long as p is bigger than 0
-  for (int p = parent(i); p > 0; p = parent(p)) {
+  //we then check loop as long as i is not the root (position 1)
+  while (i > 1) {
+    int p = parent(i, Arity);
     if (priorities.at(priorityQueue.at(p)) > priorities.at(priorityQueue.at(i))){ // if the priority of the parent is larger than its child, swap the element to maintain the min heap.
       std::swap(priorityQueue.at(i), priorityQueue.at(p)); //swap child with parent in the priorityQueue.
       std::swap(indexToPosition.at(priorityQueue.at(i)), indexToPosition.at(priorityQueue.at(p))); //swap the indexToPosition position of the parent and child.
@@ -183,8 +322,8 @@ void IndexPriorityQueue<T>::swim(int i) {
 }
 
 /* The top function returns the minimum element. In the case of a min heap, that would be first element in the heap. */
-template <typename T>
-std::pair<T, int> IndexPriorityQueue<T>::top() const {
+template <typename T, int Arity>
+std::pair<T, int> IndexPriorityQueue<T, Arity>::top() const {
   if (size_ > 0){ // if there are elements in the heap.
     return {priorities.at(priorityQueue.at(1)), priorityQueue.at(1)}; //return the priority of the first element, as well as what it's referred as (name - priorityQueue).
   }
@@ -192,12 +331,22 @@ std::pair<T, int> IndexPriorityQueue<T>::top() const {
   return {T {}, 0};
 }
 
+template <typename T, int Arity>
+const T& IndexPriorityQueue<T, Arity>::topKey() const {
+  return priorities.at(priorityQueue.at(1));
+}
+
+template <typename T, int Arity>
+int IndexPriorityQueue<T, Arity>::topIndex() const {
+  return priorityQueue.at(1);
+}
+
 // if vertex i is not present, insert it with key
 // otherwise change the associated key value of i to key
 /* The changeKey function pushes an index with a priority if there is no element with patientName in the index priority queue. 
 If there is already an element with that patientName, change it's priority and then swim or sink to the right position in the heap accordingly. */
-template <typename T>
-void IndexPriorityQueue<T>::changeKey(const T& key, int patientName) {
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::changeKey(const T& key, int patientName) {
   if (!contains(patientName)){ //if there no patietName with patientName in the index priority queue-
     push(key, patientName); //-push element inside with that patientName.
   }
@@ -208,12 +357,354 @@ void IndexPriorityQueue<T>::changeKey(const T& key, int patientName) {
   }
 }
 
+template <typename T, int Arity>
+void IndexPriorityQueue<T, Arity>::changeKey(T&& key, int name) {
+  if (!contains(name)) {
+    push(std::move(key), name);
+    return;
+  }
+  priorities.at(name) = std::move(key);
+  swim(indexToPosition.at(name));
+  sink(indexToPosition.at(name));
+}
+
 /* The contains function checks if the index priority queue contains index as element */
-template <typename T>
-bool IndexPriorityQueue<T>::contains(int index) const {
+template <typename T, int Arity>
+bool IndexPriorityQueue<T, Arity>::contains(int index) const {
   if(index >= maxSize_ || index < 0) return false; //Checks if the index is within range(In-bound)? if yes,- 
   return indexToPosition.at(index) != -1; //- check if it's in the queue.
 }
 
+// Finding the smallest of the children of a node in a 4-ary or 8-ary heap
+// whose keys lie next to each other.  For int and float keys this is done
+// with SSE4.1 or AVX2 instructions when the processor has them, checked
+// once at run time, so the same binary still runs on older machines.
+// Every function returns the offset of the first smallest key, the one the
+// scalar loop would pick.
+namespace heap_simd {
+
+template <typename T>
+int firstMinimum(const T* keys, int count) {
+  int smallest = 0;
+  for (int i = 1; i < count; ++i) {
+    if (keys[i] < keys[smallest]) {
+      smallest = i;
+    }
+  }
+  return smallest;
+}
+
+#ifdef INDEX_PQ_X86_SIMD
+
+inline bool hasSse41() {
+  static const bool has = (__builtin_cpu_init(), __builtin_cpu_supports("sse4.1"));
+  return has;
+}
+
+inline bool hasAvx2() {
+  static const bool has = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+  return has;
+}
+
+// each kernel spreads the minimum to every lane, then finds the first lane
+// equal to it.  No lane matches only if a float key is NaN; the scalar
+// loop decides then
+__attribute__((target("sse4.1")))
+inline int firstMinimum4(const int* keys) {
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+  __m128i m = _mm_min_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+  return __builtin_ctz(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, m))));
+}
+
+__attribute__((target("sse4.1")))
+inline int firstMinimum4(const float* keys) {
+  __m128 v = _mm_loadu_ps(keys);
+  __m128 m = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+  m = _mm_min_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+  int mask = _mm_movemask_ps(_mm_cmpeq_ps(v, m));
+  return mask != 0 ? __builtin_ctz(mask) : firstMinimum(keys, 4);
+}
+
+// eight keys with SSE4.1, as two halves
+template <typename T>
+__attribute__((target("sse4.1")))
+int firstMinimum8Sse(const T* keys) {
+  int low = firstMinimum4(keys);
+  int high = 4 + firstMinimum4(keys + 4);
+  return keys[high] < keys[low] ? high : low;
+}
+
+__attribute__((target("avx2")))
+inline int firstMinimum8(const int* keys) {
+  __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+  __m256i m = _mm256_min_epi32(v, _mm256_permute2x128_si256(v, v, 1));
+  m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+  m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+  return __builtin_ctz(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, m))));
+}
+
+__attribute__((target("avx2")))
+inline int firstMinimum8(const float* keys) {
+  __m256 v = _mm256_loadu_ps(keys);
+  __m256 m = _mm256_min_ps(v, _mm256_permute2f128_ps(v, v, 1));
+  m = _mm256_min_ps(m, _mm256_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+  m = _mm256_min_ps(m, _mm256_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+  int mask = _mm256_movemask_ps(_mm256_cmp_ps(v, m, _CMP_EQ_OQ));
+  return mask != 0 ? __builtin_ctz(mask) : firstMinimum(keys, 8);
+}
+
+#endif  // INDEX_PQ_X86_SIMD
+
+// the smallest of Count keys, vectorised where there is a kernel for it
+template <typename T, int Count>
+int childMinimum(const T* keys) {
+#ifdef INDEX_PQ_X86_SIMD
+  if constexpr ((std::is_same_v<T, int> || std::is_same_v<T, float>)
+                && (Count == 4 || Count == 8)) {
+    if constexpr (Count == 8) {
+      if (hasAvx2()) {
+        return firstMinimum8(keys);
+      }
+      if (hasSse41()) {
+        return firstMinimum8Sse(keys);
+      }
+    } else if (hasSse41()) {
+      return firstMinimum4(keys);
+    }
+  }
+#endif
+  return firstMinimum(keys, Count);
+}
+
+}  // namespace heap_simd
+
+// The same queue with the keys kept in the heap itself: keys.at(p) is the
+// key of the entry at heap position p and indices.at(p) its index, so sink
+// and swim compare keys that sit next to each other instead of looking
+// each one up in an N-sized array of priorities.  indexToPosition still
+// finds an index in the heap.  Copying a key on every move only pays off
+// for small keys such as int or double, so this is for trivially copyable
+// T; IndexPriorityQueue stays the general queue.
+//
+// The children of a node have their keys side by side, so with Arity 4 or
+// 8 and int or float keys sink picks the smallest child with
+// heap_simd::childMinimum.  Simd = false keeps the scalar loop, for
+// comparison.
+template <typename T, int Arity = 2, bool Simd = true>
+class PackedIndexPriorityQueue {
+  static_assert(Arity >= 2, "a heap node needs at least two children");
+  static_assert(std::is_trivially_copyable_v<T>,
+                "packed heap entries are for small trivially copyable keys");
+
+ private:
+  // position 0 is unused so positions start at 1 as in IndexPriorityQueue:
+  // keys.at(i) <= keys.at(c) for every child c of i
+  std::vector<T> keys {};
+  std::vector<int> indices {};
+  // indexToPosition.at(i) is the position in the heap of index i, -1 if absent
+  std::vector<int> indexToPosition {};
+  int size_ = 0;
+  int maxSize_ = 0;
+
+ public:
+  explicit PackedIndexPriorityQueue(int);
+  void push(const T&, int);
+  // remove everything, in time proportional to size() rather than N
+  void clear();
+  void pop();
+  void erase(int);
+  bool contains(int) const;
+  void changeKey(const T&, int);
+  std::pair<T, int> top() const;
+  // as in IndexPriorityQueue, throw std::out_of_range if the queue is empty
+  const T& topKey() const;
+  int topIndex() const;
+  bool empty() const;
+  int size() const;
+  int maxSize() const;
+
+ private:
+  // put an entry at position and record where its index now is
+  void place(int position, const T& key, int index);
+  // position of the smallest of the children first, ..., last
+  int smallestChild(int first, int last) const;
+  void swim(int position);
+  void sink(int position);
+};
+
+template <typename T, int Arity, bool Simd>
+PackedIndexPriorityQueue<T, Arity, Simd>::PackedIndexPriorityQueue(int N) {
+  keys.push_back(T {});
+  indices.push_back(int {});
+  indexToPosition.resize(N, -1);
+  size_ = 0;
+  maxSize_ = N;
+}
+
+template <typename T, int Arity, bool Simd>
+bool PackedIndexPriorityQueue<T, Arity, Simd>::empty() const {
+  return size_ == 0;
+}
+
+template <typename T, int Arity, bool Simd>
+int PackedIndexPriorityQueue<T, Arity, Simd>::size() const {
+  return size_;
+}
+
+template <typename T, int Arity, bool Simd>
+int PackedIndexPriorityQueue<T, Arity, Simd>::maxSize() const {
+  return maxSize_;
+}
+
+template <typename T, int Arity, bool Simd>
+bool PackedIndexPriorityQueue<T, Arity, Simd>::contains(int index) const {
+  if (index >= maxSize_ || index < 0) return false;
+  return indexToPosition.at(index) != -1;
+}
+
+template <typename T, int Arity, bool Simd>
+void PackedIndexPriorityQueue<T, Arity, Simd>::place(int position, const T& key,
+                                                     int index) {
+  keys[position] = key;
+  indices[position] = index;
+  indexToPosition[index] = position;
+}
+
+// push does nothing if index is already in the queue
+template <typename T, int Arity, bool Simd>
+void PackedIndexPriorityQueue<T, Arity, Simd>::push(const T& priority, int index) {
+  if (contains(index)) {
+    return;
+  }
+  keys.push_back(priority);
+  indices.push_back(index);
+  ++size_;
+  indexToPosition.at(index) = size_;
+  swim(size_);
+}
+
+template <typename T, int Arity, bool Simd>
+void PackedIndexPriorityQueue<T, Arity, Simd>::clear() {
+  for (int position = 1; position <= size_; ++position) {
+    indexToPosition.at(indices.at(position)) = -1;
+  }
+  keys.resize(1);
+  indices.resize(1);
+  size_ = 0;
+}
+
+template <typename T, int Arity, bool Simd>
+void PackedIndexPriorityQueue<T, Arity, Simd>::pop() {
+  if (size_ == 0) {
+    std::cout << "no elements in the heap" << '\n';
+    return;
+  }
+  erase(indices.at(1));
+}
+
+// the last entry fills the hole and is moved up or down from there
+template <typename T, int Arity, bool Simd>
+void PackedIndexPriorityQueue<T, Arity, Simd>::erase(int index) {
+  if (!contains(index)) {
+    return;
+  }
+  int position = indexToPosition.at(index);
+  T lastKey = keys.at(size_);
+  int lastIndex = indices.at(size_);
+  indexToPosition.at(index) = -1;
+  keys.pop_back();
+  indices.pop_back();
+  --size_;
+  if (position > size_) {
+    return;        // index was the last entry
+  }
+  place(position, lastKey, lastIndex);
+  swim(position);
+  sink(indexToPosition.at(lastIndex));
+}
+
+template <typename T, int Arity, bool Simd>
+int PackedIndexPriorityQueue<T, Arity, Simd>::smallestChild(int first,
+                                                            int last) const {
+  if constexpr (Simd) {
+    if (last - first + 1 == Arity) {
+      return first + heap_simd::childMinimum<T, Arity>(keys.data() + first);
+    }
+  }
+  return first + heap_simd::firstMinimum(keys.data() + first, last - first + 1);
+}
+
+// Both loops carry the moving entry in locals and shift the entries it
+// passes by one level, writing it once where it stops rather than swapping
+// at every step.
+template <typename T, int Arity, bool Simd>
+void PackedIndexPriorityQueue<T, Arity, Simd>::sink(int position) {
+  T movingKey = keys.at(position);
+  int movingIndex = indices.at(position);
+  int current = position;
+  while (firstChild(current, Arity) <= size_) {
+    int first = firstChild(current, Arity);
+    int smallest = smallestChild(first, std::min(first + Arity - 1, size_));
+    if (!(keys[smallest] < movingKey)) {
+      break;
+    }
+    place(current, keys[smallest], indices[smallest]);
+    current = smallest;
+  }
+  if (current != position) {
+    place(current, movingKey, movingIndex);
+  }
+}
+
+template <typename T, int Arity, bool Simd>
+void PackedIndexPriorityQueue<T, Arity, Simd>::swim(int position) {
+  T movingKey = keys.at(position);
+  int movingIndex = indices.at(position);
+  int current = position;
+  while (current > 1) {
+    int p = parent(current, Arity);
+    if (!(movingKey < keys[p])) {
+      break;
+    }
+    place(current, keys[p], indices[p]);
+    current = p;
+  }
+  if (current != position) {
+    place(current, movingKey, movingIndex);
+  }
+}
+
+template <typename T, int Arity, bool Simd>
+std::pair<T, int> PackedIndexPriorityQueue<T, Arity, Simd>::top() const {
+  if (size_ > 0) {
+    return {keys.at(1), indices.at(1)};
+  }
+  std::cout << "no elements in the heap" << '\n';
+  return {T {}, 0};
+}
+
+template <typename T, int Arity, bool Simd>
+const T& PackedIndexPriorityQueue<T, Arity, Simd>::topKey() const {
+  return keys.at(1);
+}
+
+template <typename T, int Arity, bool Simd>
+int PackedIndexPriorityQueue<T, Arity, Simd>::topIndex() const {
+  return indices.at(1);
+}
+
+// insert index with key if it is not in the queue, otherwise change its key
+template <typename T, int Arity, bool Simd>
+void PackedIndexPriorityQueue<T, Arity, Simd>::changeKey(const T& key, int index) {
+  if (!contains(index)) {
+    push(key, index);
+    return;
+  }
+  int position = indexToPosition.at(index);
+  keys.at(position) = key;
+  swim(position);
+  sink(indexToPosition.at(index));
+}
 
 #endif      // INDEX_PRIORITY_QUEUE_HPP_
@@ -1,9 +1,14 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <vector>
+#include <string>
 #include <algorithm>
 #include <random>
 #include <limits>
+#include <numeric>
+#include <array>
+#include <cstddef>
+#include <memory_resource>
 #include "index_pq.hpp"
 #include "my_integer.hpp"
 
@@ -336,6 +341,416 @@ TEST(IndexPriorityQueueTest, operationsOnPrioritiesBig) {
   ASSERT_LE(MyInteger::constructorCount, N);
 }
 
+TEST(DAryIndexPriorityQueueTest, helpers) {
+  // with arity 2 the d-ary helpers agree with the binary ones
+  for (int i = 1; i < 50; ++i) {
+    EXPECT_EQ(firstChild(i, 2), leftChild(i));
+    EXPECT_EQ(parent(firstChild(i, 2), 2), i);
+    EXPECT_EQ(parent(rightChild(i), 2), parent(rightChild(i)));
+  }
+  for (int c = firstChild(3, 4); c < firstChild(3, 4) + 4; ++c) {
+    EXPECT_EQ(parent(c, 4), 3);
+  }
+  EXPECT_EQ(firstChild(1, 8), 2);
+  EXPECT_EQ(firstChild(2, 8), 10);
+}
+
+// push shuffled priorities, change some keys, erase a few and check
+// everything comes out in sorted order
+template <int Arity>
+void dAryHelper(int N, unsigned seed) {
+  std::mt19937 mt {seed};
+  std::vector<int> priorities(N);
+  std::iota(priorities.begin(), priorities.end(), -N / 2);
+  std::shuffle(priorities.begin(), priorities.end(), mt);
+  IndexPriorityQueue<int, Arity> heap(N);
+  for (int i = 0; i < N; ++i) {
+    heap.push(priorities.at(i), i);
+  }
+  std::uniform_int_distribution<int> index {0, N - 1};
+  std::uniform_int_distribution<int> shift {-N, N};
+  for (int k = 0; k < N; ++k) {
+    int i = index(mt);
+    priorities.at(i) += shift(mt);
+    heap.changeKey(priorities.at(i), i);
+  }
+  for (int k = 0; k < N / 4; ++k) {
+    int i = index(mt);
+    heap.erase(i);
+    priorities.at(i) = std::numeric_limits<int>::max();
+  }
+  std::vector<int> popped {};
+  while (!heap.empty()) {
+    auto [priority, i] = heap.top();
+    ASSERT_EQ(priority, priorities.at(i));
+    popped.push_back(priority);
+    heap.pop();
+  }
+  std::vector<int> expected {};
+  for (int priority : priorities) {
+    if (priority != std::numeric_limits<int>::max()) {
+      expected.push_back(priority);
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+  ASSERT_EQ(popped, expected);
+}
+
+TEST(DAryIndexPriorityQueueTest, randomOperations) {
+  dAryHelper<2>(200, 7);
+  dAryHelper<3>(200, 7);
+  dAryHelper<4>(200, 8);
+  dAryHelper<8>(200, 9);
+  dAryHelper<8>(5, 10);
+}
+
+template <int Arity>
+void dAryOperationsOnPriorities(int N) {
+  std::mt19937 mt {42};
+  std::vector<int> intPriorities(N);
+  std::iota(intPriorities.begin(), intPriorities.end(), 101);
+  std::shuffle(intPriorities.begin(), intPriorities.end(), mt);
+  std::vector<MyInteger> priorities(N);
+  for (int i = 0; i < N; ++i) {
+    priorities.at(i) = MyInteger {intPriorities.at(i)};
+  }
+  IndexPriorityQueue<MyInteger, Arity> heap(N);
+  MyInteger::clearCounts();
+  for (int i = 0; i < N; ++i) {
+    heap.push(priorities.at(i), i);
+  }
+  ASSERT_LE(MyInteger::assignmentCount, N);
+  ASSERT_LE(MyInteger::copyCount, N);
+  ASSERT_LE(MyInteger::constructorCount, N);
+  std::sort(priorities.begin(), priorities.end());
+  MyInteger::clearCounts();
+  for (const auto& x : priorities) {
+    ASSERT_EQ(x, heap.top().first);
+    heap.pop();
+  }
+  ASSERT_LE(MyInteger::assignmentCount, N);
+  ASSERT_LE(MyInteger::copyCount, N);
+  ASSERT_LE(MyInteger::constructorCount, N);
+}
+
+TEST(DAryIndexPriorityQueueTest, operationsOnPriorities) {
+  dAryOperationsOnPriorities<4>(100);
+  dAryOperationsOnPriorities<8>(100);
+}
+
+// run the same random operations on a packed queue and on the indirect
+// one; they can break ties differently, so compare keys, and check the
+// index that comes out has that key
+template <typename T, int Arity, bool Simd = true>
+void packedHelper(int N, unsigned seed) {
+  std::mt19937 mt {seed};
+  std::uniform_int_distribution<int> index {0, N - 1};
+  std::uniform_int_distribution<int> key {-N, N};
+  std::uniform_int_distribution<int> operation {0, 9};
+  PackedIndexPriorityQueue<T, Arity, Simd> packed(N);
+  IndexPriorityQueue<T, Arity> indirect(N);
+  std::vector<T> priorities(N);
+  for (int k = 0; k < 20 * N; ++k) {
+    int op = operation(mt);
+    int i = index(mt);
+    if (op < 4) {
+      if (!packed.contains(i)) {
+        priorities.at(i) = static_cast<T>(key(mt));
+      }
+      packed.push(priorities.at(i), i);
+      indirect.push(priorities.at(i), i);
+    } else if (op < 7) {
+      priorities.at(i) = static_cast<T>(key(mt));
+      packed.changeKey(priorities.at(i), i);
+      indirect.changeKey(priorities.at(i), i);
+    } else if (op < 8) {
+      packed.erase(i);
+      indirect.erase(i);
+    } else if (!indirect.empty()) {
+      ASSERT_EQ(packed.top().first, indirect.top().first);
+      packed.pop();
+      indirect.pop();
+    }
+    ASSERT_EQ(packed.size(), indirect.size());
+    ASSERT_EQ(packed.contains(i), indirect.contains(i));
+    if (!packed.empty()) {
+      auto [priority, top] = packed.top();
+      ASSERT_EQ(priority, indirect.top().first);
+      ASSERT_EQ(priority, priorities.at(top));
+    }
+  }
+  T previous = std::numeric_limits<T>::lowest();
+  while (!packed.empty()) {
+    ASSERT_LE(previous, packed.top().first);
+    previous = packed.top().first;
+    packed.pop();
+  }
+}
+
+TEST(PackedIndexPriorityQueueTest, matchesIndirectLayout) {
+  packedHelper<int, 2>(200, 11);
+  packedHelper<int, 4>(200, 12);
+  packedHelper<double, 2>(200, 13);
+  packedHelper<double, 8>(50, 14);
+  packedHelper<int, 3>(3, 15);
+}
+
+TEST(PackedIndexPriorityQueueTest, simdMatchesScalar) {
+  packedHelper<int, 4>(300, 21);
+  packedHelper<int, 8>(300, 22);
+  packedHelper<float, 4>(300, 23);
+  packedHelper<float, 8>(300, 24);
+  packedHelper<int, 8, false>(300, 22);
+  packedHelper<float, 8, false>(300, 24);
+}
+
+// the vectorised child minimum picks the same child as the scalar loop,
+// the first smallest when there are ties
+template <typename T, int Count>
+void childMinimumHelper(unsigned seed) {
+  std::mt19937 mt {seed};
+  std::uniform_int_distribution<int> key {-3, 3};
+  std::vector<T> keys(Count);
+  for (int k = 0; k < 1000; ++k) {
+    for (T& x : keys) {
+      x = static_cast<T>(key(mt));
+    }
+    ASSERT_EQ((heap_simd::childMinimum<T, Count>(keys.data())),
+              heap_simd::firstMinimum(keys.data(), Count));
+#ifdef INDEX_PQ_X86_SIMD
+    // the SSE4.1 path for eight keys, which AVX2 hides where it is present
+    if constexpr (Count == 8 && !std::is_same_v<T, double>) {
+      if (heap_simd::hasSse41()) {
+        ASSERT_EQ(heap_simd::firstMinimum8Sse(keys.data()),
+                  heap_simd::firstMinimum(keys.data(), Count));
+      }
+    }
+#endif
+  }
+  keys.assign(Count, std::numeric_limits<T>::max());
+  keys.back() = std::numeric_limits<T>::lowest();
+  ASSERT_EQ((heap_simd::childMinimum<T, Count>(keys.data())), Count - 1);
+}
+
+TEST(PackedIndexPriorityQueueTest, childMinimum) {
+  childMinimumHelper<int, 4>(31);
+  childMinimumHelper<int, 8>(32);
+  childMinimumHelper<float, 4>(33);
+  childMinimumHelper<float, 8>(34);
+  childMinimumHelper<double, 8>(35);
+}
+
+TEST(PackedIndexPriorityQueueTest, eraseAndContains) {
+  PackedIndexPriorityQueue<double> heap(4);
+  EXPECT_FALSE(heap.contains(-1));
+  EXPECT_FALSE(heap.contains(4));
+  heap.push(2.5, 0);
+  heap.push(1.5, 1);
+  heap.push(3.5, 2);
+  heap.push(9.0, 2);
+  EXPECT_EQ(heap.size(), 3);
+  EXPECT_EQ(heap.top(), std::make_pair(1.5, 1));
+  heap.erase(1);
+  heap.erase(1);
+  EXPECT_FALSE(heap.contains(1));
+  EXPECT_EQ(heap.top(), std::make_pair(2.5, 0));
+  heap.changeKey(0.5, 2);
+  EXPECT_EQ(heap.top(), std::make_pair(0.5, 2));
+  heap.erase(0);
+  heap.pop();
+  EXPECT_TRUE(heap.empty());
+  EXPECT_EQ(heap.maxSize(), 4);
+}
+
+TEST(BulkBuildTest, assignHeapifies) {
+  int N = 500;
+  std::mt19937 mt {51};
+  std::vector<std::pair<int, int> > entries {};
+  for (int i = 0; i < N; i += 2) {
+    entries.push_back({static_cast<int>(mt() % 100), i});
+  }
+  std::shuffle(entries.begin(), entries.end(), mt);
+  // an index given twice keeps its first priority, like push
+  entries.push_back({-1, entries.front().second});
+  IndexPriorityQueue<int, 4> heap(N, entries);
+  ASSERT_EQ(heap.size(), N / 2);
+  std::vector<int> expected {};
+  for (int k = 0; k < N / 2; ++k) {
+    expected.push_back(entries.at(k).first);
+  }
+  std::sort(expected.begin(), expected.end());
+  std::vector<int> popped {};
+  while (!heap.empty()) {
+    popped.push_back(heap.top().first);
+    heap.pop();
+  }
+  ASSERT_EQ(popped, expected);
+}
+
+TEST(BulkBuildTest, assignReplacesContents) {
+  IndexPriorityQueue<int> heap(10);
+  heap.push(5, 0);
+  heap.push(3, 1);
+  heap.assign({{7, 2}, {4, 3}, {9, 1}});
+  EXPECT_FALSE(heap.contains(0));
+  EXPECT_EQ(heap.size(), 3);
+  EXPECT_EQ(heap.top(), std::make_pair(4, 3));
+  heap.changeKey(1, 1);
+  EXPECT_EQ(heap.top(), std::make_pair(1, 1));
+  heap.assign({});
+  EXPECT_TRUE(heap.empty());
+  EXPECT_THROW(heap.assign({{1, 10}}), std::out_of_range);
+}
+
+// a bad index anywhere in the entries leaves the queue as it was
+TEST(BulkBuildTest, assignWithBadIndexChangesNothing) {
+  IndexPriorityQueue<int> heap(10);
+  heap.push(5, 0);
+  heap.push(3, 1);
+  heap.push(8, 2);
+  EXPECT_THROW(heap.assign({{7, 4}, {1, 5}, {2, -1}, {0, 6}}), std::out_of_range);
+  EXPECT_THROW(heap.assign({{7, 4}, {1, 10}}), std::out_of_range);
+  EXPECT_EQ(heap.size(), 3);
+  for (int i = 4; i < 10; ++i) {
+    EXPECT_FALSE(heap.contains(i));
+  }
+  EXPECT_EQ(heap.top(), std::make_pair(3, 1));
+  heap.pop();
+  EXPECT_EQ(heap.top(), std::make_pair(5, 0));
+  heap.pop();
+  EXPECT_EQ(heap.top(), std::make_pair(8, 2));
+  heap.pop();
+  EXPECT_TRUE(heap.empty());
+}
+
+// building a binary heap bottom up takes at most 2 N comparisons, pushing
+// keys in decreasing order takes about N log N
+TEST(BulkBuildTest, linearComparisons) {
+  int N = 4096;
+  std::vector<std::pair<MyInteger, int> > entries {};
+  for (int i = 0; i < N; ++i) {
+    entries.push_back({MyInteger {N - i}, i});
+  }
+  IndexPriorityQueue<MyInteger> pushed(N);
+  MyInteger::clearCounts();
+  for (const auto& [priority, i] : entries) {
+    pushed.push(priority, i);
+  }
+  int pushComparisons = MyInteger::comparisonCount;
+  IndexPriorityQueue<MyInteger> built(N);
+  MyInteger::clearCounts();
+  built.assign(entries);
+  ASSERT_LE(MyInteger::comparisonCount, 2 * N);
+  ASSERT_LT(2 * MyInteger::comparisonCount, pushComparisons);
+  for (int k = 1; k <= N; ++k) {
+    ASSERT_EQ(built.top().first, MyInteger {k});
+    built.pop();
+  }
+}
+
+TEST(ClearTest, clearEmptiesTheQueue) {
+  IndexPriorityQueue<int, 4> heap(20);
+  for (int i = 0; i < 20; i += 3) {
+    heap.push(20 - i, i);
+  }
+  heap.clear();
+  EXPECT_TRUE(heap.empty());
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_FALSE(heap.contains(i));
+  }
+  heap.push(4, 3);
+  heap.push(2, 6);
+  heap.changeKey(1, 3);
+  EXPECT_EQ(heap.top(), std::make_pair(1, 3));
+  EXPECT_EQ(heap.size(), 2);
+
+  PackedIndexPriorityQueue<int> packed(20);
+  packed.push(5, 1);
+  packed.push(4, 2);
+  packed.clear();
+  EXPECT_TRUE(packed.empty());
+  EXPECT_FALSE(packed.contains(1));
+  packed.push(7, 2);
+  EXPECT_EQ(packed.top(), std::make_pair(7, 2));
+}
+
+// a queue in a fixed buffer with no upstream resource: any allocation
+// beyond the buffer would throw std::bad_alloc
+TEST(ClearTest, queueInABuffer) {
+  int N = 1000;
+  std::array<std::byte, 16 * 1024> buffer {};
+  std::pmr::monotonic_buffer_resource arena {buffer.data(), buffer.size(),
+                                             std::pmr::null_memory_resource()};
+  IndexPriorityQueue<int, 4> heap(N, &arena);
+  std::mt19937 mt {81};
+  for (int round = 0; round < 3; ++round) {
+    std::vector<int> priorities(N);
+    for (int i = 0; i < N; ++i) {
+      priorities.at(i) = static_cast<int>(mt() % 100);
+      heap.push(priorities.at(i), i);
+    }
+    std::sort(priorities.begin(), priorities.end());
+    for (int k = 0; k < N / 2; ++k) {
+      ASSERT_EQ(heap.top().first, priorities.at(k));
+      heap.pop();
+    }
+    heap.clear();
+  }
+  std::array<std::byte, 1024> small {};
+  std::pmr::monotonic_buffer_resource tooSmall {small.data(), small.size(),
+                                                std::pmr::null_memory_resource()};
+  EXPECT_THROW((IndexPriorityQueue<int>(N, &tooSmall)), std::bad_alloc);
+}
+
+// with rvalue priorities, emplace and topKey/topIndex the queue moves
+// MyIntegers around but never copies one
+TEST(MoveTest, noCopiesOnTheHotPath) {
+  int N = 200;
+  std::mt19937 mt {91};
+  std::vector<int> values(N);
+  std::iota(values.begin(), values.end(), 0);
+  std::shuffle(values.begin(), values.end(), mt);
+  IndexPriorityQueue<MyInteger, 4> heap(N);
+  MyInteger::clearCounts();
+  for (int i = 0; i < N / 2; ++i) {
+    heap.push(MyInteger {values.at(i)}, i);
+  }
+  for (int i = N / 2; i < N; ++i) {
+    heap.emplace(i, values.at(i));
+  }
+  for (int i = 0; i < N; i += 3) {
+    values.at(i) -= N;
+    heap.changeKey(MyInteger {values.at(i)}, i);
+  }
+  std::vector<int> popped {};
+  while (!heap.empty()) {
+    ASSERT_EQ(heap.topKey().value, values.at(heap.topIndex()));
+    popped.push_back(heap.topKey().value);
+    heap.pop();
+  }
+  EXPECT_EQ(MyInteger::copyCount, 0);
+  EXPECT_EQ(MyInteger::assignmentCount, 0);
+  EXPECT_EQ(MyInteger::moveCount, N + N / 3 + 1);
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(popped, values);
+  EXPECT_THROW(heap.topKey(), std::out_of_range);
+  EXPECT_THROW(heap.topIndex(), std::out_of_range);
+}
+
+TEST(MoveTest, emplaceAndMoveBehaveLikePush) {
+  IndexPriorityQueue<std::string> heap(4);
+  std::string key {"pear"};
+  heap.push(std::move(key), 0);
+  heap.emplace(1, 3, 'a');
+  heap.emplace(1, "ignored");
+  heap.changeKey(std::string {"apple"}, 2);
+  EXPECT_EQ(heap.size(), 3);
+  EXPECT_EQ(heap.topKey(), "aaa");
+  EXPECT_EQ(heap.topIndex(), 1);
+  heap.changeKey(std::string {"zebra"}, 1);
+  EXPECT_EQ(heap.top(), std::make_pair(std::string {"apple"}, 2));
+}
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();